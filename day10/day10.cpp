@@ -1,172 +1,295 @@
 ﻿#include "loader.h"
+#include "gf2.h"
+#include "ilp.h"
+#include <bit>
 #include <iostream>
 #include <cstdlib>
 #include <vector>
 #include <limits>
 #include <algorithm>
 #include <ranges>
-#include <helpers.h>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include "hash.h"
+#include "parallel.h"
 
-using jolt_point_t = std::vector<size_t>;
 
 
-
-
-template<bool return_all=false>
-auto find_shortest_ways_part_1(Configuration c)
+// Minimum number of presses to reach target_state, via GF(2) elimination:
+// only the 2^nullity solutions of the button system are visited, Gray-code
+// ordered so each step is one XOR. Returns (presses, combination) of the best.
+template<class State>
+std::pair<size_t, size_t> find_shortest_ways_part_1(const Configuration<State>& c)
 {
     size_t min_presses = std::numeric_limits<size_t>::max();
     size_t best_combination = 0;
-	std::vector<std::pair<size_t,size_t>> successful_ways_and_combinations;
-    const size_t total_combinations = tools::pow2<size_t>(static_cast<unsigned int>(c.buttons.size()));
-    for (size_t i = 0; i < total_combinations; ++i)
+    const auto solutions = solve_gf2(c.buttons, c.target_state, c.lights);
+    for_each_gf2_solution(solutions, [&](uint64_t combination)
     {
-        size_t current_combination = i;
-        c.curr_state = 0;
-        size_t presses = 0;
+        const size_t presses = static_cast<size_t>(std::popcount(combination));
+        if (presses < min_presses)
+        {
+            best_combination = static_cast<size_t>(combination);
+            min_presses = presses;
+        }
+    });
+    return { min_presses, best_combination };
+}
+
+
+
+// Part 2 by parity bifurcation: the buttons pressed an odd number of times
+// must fix the parity of every counter, after pressing them once all
+// counters are even and the rest of the problem is the halved vector,
+// pressed twice. Subproblems repeat a lot, so they are memoized on the jolt
+// vector; the pressing patterns for a parity are computed once per machine.
+constexpr size_t max_bifurcation_counters = 16;
+constexpr size_t max_bifurcation_jolt = std::numeric_limits<uint16_t>::max();
+
+template<class State>
+class ParityBifurcation
+{
+public:
+    static constexpr size_t max_counters = max_bifurcation_counters;
+    static constexpr size_t unreachable = std::numeric_limits<size_t>::max();
+    using jolt_key_t = std::array<uint16_t, max_counters>;
 
-        for (size_t j = 0; j < c.buttons.size(); ++j)
+    explicit ParityBifurcation(const Configuration<State>& c) : config(c)
+    {
+        if (c.jolts.size() > max_counters)
         {
-            if ((current_combination & 1) != 0)
-            {
-                presses++;
-                c.press_button(j);
-            }
-            current_combination >>= 1;
+            throw std::runtime_error("Jolt size exceeds 16, not supported");
         }
-        if (c.curr_state == c.target_state)
+    }
+
+    size_t solve()
+    {
+        jolt_key_t jolts{};
+        for (size_t i = 0; i < config.jolts.size(); ++i)
         {
-            if constexpr (return_all)
-            {
-                successful_ways_and_combinations.push_back({ presses, i });
-            }
-            if (presses < min_presses)
+            if (config.jolts[i] > max_bifurcation_jolt)
             {
-                best_combination = i;
-                min_presses = presses;
+                throw std::runtime_error("Jolt value exceeds 16 bits");
             }
+            jolts[i] = static_cast<uint16_t>(config.jolts[i]);
         }
+        return solve(jolts);
     }
-    if constexpr (!return_all)
-        return std::pair{ min_presses, best_combination };
-    else
-        return successful_ways_and_combinations;
-}
-
-
 
-std::vector<std::pair<size_t, size_t>> find_all_ways_to_even_jolts(Configuration c)
- {
-     if (c.jolts.size() > 16)
-     {
-		 std::cerr << "Jolt size exceeds 16, not supported\n";
-         exit(1);
-     }
-     c.target_state = 0;
-     for(size_t i=0;i<c.jolts.size();i++)
-     {
-       
-         if (c.jolts[c.jolts.size()-1-i] % 2 != 0)
-         {
-             //schiebe ein eins rein
-             c.target_state = c.target_state << 1 | 1;
-         }
-		 else
-		 {
-			 c.target_state = c.target_state << 1;
-		 }
-     }
-     //std::cout << std::bitset<16>(c.target_state) << '\n';
-     return find_shortest_ways_part_1<true>(c);
- }
+private:
+    // one way to fix a parity: its presses and how much it takes off each counter
+    struct Pattern
+    {
+        size_t presses;
+        jolt_key_t decrement;
+    };
 
-size_t find_shortest_way_to_zero_jolts(const Configuration& c)
- {
-	auto ways = find_all_ways_to_even_jolts(c);
-	size_t ret_steps_to_even = std::numeric_limits<size_t>::max();
-    for (auto& [steps_to_even,way_to_even] : ways)
+    struct JoltKeyHash
     {
-        if (ret_steps_to_even == 0)
+        size_t operator()(const jolt_key_t& key) const noexcept
         {
-            std::cout << "jetzt \n";
+            return static_cast<size_t>(tools::hash_bytes(reinterpret_cast<const char*>(key.data()), sizeof(key), 0x9e3779b97f4a7c15ull));
         }
-        bool skip = false;
-		//apply this way
-        Configuration c_neu = c;
-        //go the way to even jolts
-        size_t current_combination = way_to_even;
-        for (size_t j = 0; j < c_neu.buttons.size(); ++j)
+    };
+
+    const std::vector<Pattern>& patterns_for(uint16_t parity)
+    {
+        auto [it, inserted] = patterns.try_emplace(parity);
+        if (inserted)
         {
-            if ((current_combination & 1) != 0)
+            State target{};
+            for_each_set_bit(parity, [&](size_t bit) { set_bit(target, bit); });
+            const auto solutions = solve_gf2(config.buttons, target, config.jolts.size());
+            for_each_gf2_solution(solutions, [&](uint64_t combination)
             {
-                bool ok = c_neu.press_button_to_joltage(j);
-                if(!ok)
-                { 
-                    skip = true;
-                    break;
+                Pattern pattern{ static_cast<size_t>(std::popcount(combination)), {} };
+                for (uint64_t rest = combination; rest != 0; rest &= rest - 1)
+                {
+                    for_each_set_bit(config.buttons[std::countr_zero(rest)], [&](size_t bit)
+                    {
+                        if (bit < config.jolts.size())
+                        {
+                            ++pattern.decrement[bit];
+                        }
+                    });
                 }
-            }
-            current_combination >>= 1;
+                it->second.push_back(pattern);
+            });
         }
-        if (skip)
-			continue;
-        //if alls are zero , we are done
-        bool all_zero = std::ranges::all_of(c_neu.jolts, [](size_t x) { return x == 0; });
-        if (all_zero)
+        return it->second;
+    }
+
+    size_t solve(const jolt_key_t& jolts)
+    {
+        if (std::ranges::all_of(jolts, [](uint16_t x) { return x == 0; }))
         {
-			ret_steps_to_even = std::min(ret_steps_to_even, steps_to_even);
-            continue;
+            return 0;
         }
-        //now all jolts are even, divide by 2
-        for (size_t i = 0; i < c_neu.jolts.size(); ++i)
+        if (auto it = memo.find(jolts); it != memo.end())
         {
-            c_neu.jolts[i] /= 2;
+            return it->second;
         }
-        if (ret_steps_to_even == 0)
+
+        uint16_t parity = 0;
+        for (size_t i = 0; i < max_counters; ++i)
         {
-            std::cout << "jetzt \n";
+            parity |= static_cast<uint16_t>((jolts[i] & 1u) << i);
         }
-        size_t steps_from_this = find_shortest_way_to_zero_jolts(c_neu);
-        if(steps_from_this == std::numeric_limits<size_t>::max())
-			continue;
-		size_t steps_return_candiate = steps_to_even + 2*steps_from_this;
-        ret_steps_to_even = std::min(ret_steps_to_even,steps_return_candiate);
-        if (ret_steps_to_even == 0)
+
+        size_t best = unreachable;
+        const auto& candidates = patterns_for(parity);
+        for (size_t p = 0; p < candidates.size(); ++p)
         {
-			std::cout << "jetzt \n";
+            const Pattern& pattern = candidates[p];
+            if (pattern.presses >= best)
+            {
+                continue;
+            }
+            jolt_key_t halved{};
+            bool fits = true;
+            for (size_t i = 0; i < max_counters && fits; ++i)
+            {
+                fits = pattern.decrement[i] <= jolts[i];
+                halved[i] = static_cast<uint16_t>((jolts[i] - pattern.decrement[i]) / 2);
+            }
+            if (!fits)
+            {
+                continue;
+            }
+            const size_t rest = solve(halved);
+            if (rest != unreachable)
+            {
+                best = std::min(best, pattern.presses + 2 * rest);
+            }
         }
+        memo.emplace(jolts, best);
+        return best;
     }
-	return ret_steps_to_even;
+
+    const Configuration<State>& config;
+    std::unordered_map<uint16_t, std::vector<Pattern>> patterns{};
+    std::unordered_map<jolt_key_t, size_t, JoltKeyHash> memo{};
+};
+
+template<class State>
+size_t find_shortest_way_to_zero_jolts(const Configuration<State>& c)
+{
+    return ParityBifurcation<State>(c).solve();
+}
+
+// the bifurcation memo keys hold at most 16 counters of 16 bits each
+template<class State>
+bool fits_bifurcation(const Configuration<State>& c)
+{
+    return c.jolts.size() <= max_bifurcation_counters
+        && std::ranges::all_of(c.jolts, [](size_t jolt) { return jolt <= max_bifurcation_jolt; });
 }
  
 
 
- int main()
+// Part 2 as an integer program over the buttons' press counts, independent
+// of the 16-counter limit of the bifurcation search
+template<class State>
+size_t find_shortest_way_to_zero_jolts_ilp(const Configuration<State>& c)
+{
+    return JoltageIlp(buttons_from_configuration(c), c.jolts).solve();
+}
+
+enum class JoltSolver { bifurcation, ilp };
+
+ int main(int argc, char* argv[])
  {
- 	//part1
+    // --solver=bifurcation|ilp: backend for part 2
+    // --validate: run both part 2 backends and report differences
+    JoltSolver solver = JoltSolver::bifurcation;
+    bool validate = false;
+    for (int a = 1; a < argc; ++a)
+    {
+        const std::string arg = argv[a];
+        if (arg == "--solver=bifurcation")
+            solver = JoltSolver::bifurcation;
+        else if (arg == "--solver=ilp")
+            solver = JoltSolver::ilp;
+        else if (arg == "--validate")
+            validate = true;
+        else
+        {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+ 	//ConfigurationSet config = load_configurations("C:/source_code/advent_of_code_2025/day10/input/example.txt");
+ 	// jolts above 16 bits, solved by the ILP: 70006
+ 	//ConfigurationSet config = load_configurations("C:/source_code/advent_of_code_2025/day10/input/example_2.txt");
+    ConfigurationSet config = load_configurations("C:/source_code/advent_of_code_2025/day10/input/input.txt");
+
+    // Maschinen werden dynamisch auf die Threads verteilt, Teil 1 und Teil 2
+    // einer Maschine laufen auf demselben Thread. Ausgabe danach in Reihenfolge.
+    struct MachineResult
+    {
+        size_t part1 = 0;
+        size_t part2 = 0;
+        bool disagrees = false;
+        size_t other = 0;
+    };
+    std::vector<MachineResult> results(config.size());
+    const size_t workers = std::min(tools::worker_count(), std::max<size_t>(1, config.size()));
+    try
+    {
+        tools::parallel_for_dynamic(workers, config.size(), [&](size_t, size_t i)
+        {
+            std::visit([&](const auto& cfg)
+            {
+                MachineResult& r = results[i];
+                r.part1 = find_shortest_ways_part_1(cfg).first;
+                //part2
+                // Die Lösungsidee stammt von hier:
+                // https://www.reddit.com/r/adventofcode/comments/1pk87hl/2025_day_10_part_2_bifurcate_your_way_to_victory/
+                const bool bifurcation_fits = fits_bifurcation(cfg);
+                r.part2 = solver == JoltSolver::ilp || !bifurcation_fits ? find_shortest_way_to_zero_jolts_ilp(cfg) : find_shortest_way_to_zero_jolts(cfg);
+                if (validate && bifurcation_fits)
+                {
+                    r.other = solver == JoltSolver::ilp ? find_shortest_way_to_zero_jolts(cfg) : find_shortest_way_to_zero_jolts_ilp(cfg);
+                    r.disagrees = r.other != r.part2;
+                }
+            }, config[i]);
+        });
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error solving machines: " << ex.what() << "\n";
+        return 1;
+    }
+
  	size_t sum = 0;
- 	//std::vector<Configuration> config = load_configurations("C:/source_code/advent_of_code_2025/day10/input/example.txt");
-    std::vector<Configuration> config = load_configurations("C:/source_code/advent_of_code_2025/day10/input/input.txt");
- 	for (const auto& cfg : config)
- 	{
- 		//std::cout << "Config: target_state=" << cfg.target_state << ", buttons=" << cfg.buttons.size() << ", jolts=" << cfg.jolts.size() << "\n";
- 	    auto[result,_] = find_shortest_ways_part_1(cfg);
- 		sum += result;
- 	}
+    for (const auto& r : results)
+    {
+        sum += r.part1;
+    }
  	std::cout << "Sum of shortest ways: " << sum << "\n";
- 	//part2
-	// Die Lösungsidee stammt von hier:
-	// https://www.reddit.com/r/adventofcode/comments/1pk87hl/2025_day_10_part_2_bifurcate_your_way_to_victory/
+
 	sum = 0;
-    for (const auto& cfg : config)
+    size_t mismatches = 0;
+    std::string out;
+    out.reserve(results.size() * 32);
+    for (const auto& r : results)
     {
-        Configuration cfg_copy = cfg;
-        auto val = find_shortest_way_to_zero_jolts(cfg_copy);
-        if(val==0)
-            std::cout << "jetzt \n";
-		std::cout << "Shortest way to zero jolts: " << val << "\n";
-		sum += val;
+        if (r.disagrees)
+        {
+            out += "Backends disagree: " + std::to_string(r.part2) + " vs " + std::to_string(r.other) + "\n";
+            ++mismatches;
+        }
+        out += "Shortest way to zero jolts: " + std::to_string(r.part2) + "\n";
+		sum += r.part2;
     }
+    std::cout << out;
 	std::cout << "Sum of shortest ways to zero jolts: " << sum << "\n";
+    if (validate)
+    {
+        std::cout << "Validation: " << mismatches << " machines with different results\n";
+    }
  }
 
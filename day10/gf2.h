@@ -0,0 +1,134 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "state.h"
+
+// Solution set of "which buttons toggle the lights from 0 to target" over
+// GF(2): bit j of a combination means button j is pressed once. Every
+// solution is particular XOR a subset of null_basis.
+struct Gf2Solutions
+{
+	bool solvable{ false };
+	uint64_t particular{ 0 };
+	std::vector<uint64_t> null_basis{};
+};
+
+// Row-reduces the light x button matrix. Row i holds the buttons that toggle
+// light i, the right-hand side is bit i of target.
+template<class State>
+Gf2Solutions solve_gf2(std::span<const State> buttons, const State& target, size_t lights)
+{
+	if (buttons.size() > 64)
+	{
+		throw std::runtime_error("More than 64 buttons are not supported");
+	}
+
+	std::vector<uint64_t> rows(lights, 0);
+	std::vector<uint8_t> rhs(lights, 0);
+	for (size_t light = 0; light < lights; ++light)
+	{
+		for (size_t b = 0; b < buttons.size(); ++b)
+		{
+			if (test_bit(buttons[b], light))
+			{
+				rows[light] |= uint64_t{ 1 } << b;
+			}
+		}
+		rhs[light] = test_bit(target, light) ? 1 : 0;
+	}
+
+	// reduced row echelon form, pivot_column[r] is the button fixed by row r
+	std::vector<size_t> pivot_column;
+	size_t rank = 0;
+	for (size_t col = 0; col < buttons.size() && rank < lights; ++col)
+	{
+		const uint64_t bit = uint64_t{ 1 } << col;
+		size_t pivot = rank;
+		while (pivot < lights && (rows[pivot] & bit) == 0)
+		{
+			++pivot;
+		}
+		if (pivot == lights)
+		{
+			continue;
+		}
+		std::swap(rows[pivot], rows[rank]);
+		std::swap(rhs[pivot], rhs[rank]);
+		for (size_t r = 0; r < lights; ++r)
+		{
+			if (r != rank && (rows[r] & bit) != 0)
+			{
+				rows[r] ^= rows[rank];
+				rhs[r] ^= rhs[rank];
+			}
+		}
+		pivot_column.push_back(col);
+		++rank;
+	}
+
+	Gf2Solutions result{};
+	for (size_t r = rank; r < lights; ++r)
+	{
+		if (rhs[r] != 0)
+		{
+			return result; // 0 = 1
+		}
+	}
+	result.solvable = true;
+
+	uint64_t pivots = 0;
+	for (size_t r = 0; r < rank; ++r)
+	{
+		pivots |= uint64_t{ 1 } << pivot_column[r];
+		if (rhs[r] != 0)
+		{
+			result.particular |= uint64_t{ 1 } << pivot_column[r];
+		}
+	}
+	// one basis vector per free button: press it and fix the pivots it disturbs
+	for (size_t col = 0; col < buttons.size(); ++col)
+	{
+		const uint64_t bit = uint64_t{ 1 } << col;
+		if ((pivots & bit) != 0)
+		{
+			continue;
+		}
+		uint64_t vector = bit;
+		for (size_t r = 0; r < rank; ++r)
+		{
+			if ((rows[r] & bit) != 0)
+			{
+				vector |= uint64_t{ 1 } << pivot_column[r];
+			}
+		}
+		result.null_basis.push_back(vector);
+	}
+	return result;
+}
+
+// Calls f(combination) for all 2^nullity solutions in Gray-code order, so
+// consecutive solutions differ by a single XOR with one basis vector.
+template<class F>
+void for_each_gf2_solution(const Gf2Solutions& solutions, F f)
+{
+	if (!solutions.solvable)
+	{
+		return;
+	}
+	if (solutions.null_basis.size() >= 64)
+	{
+		throw std::runtime_error("Null space too large to enumerate");
+	}
+	uint64_t combination = solutions.particular;
+	f(combination);
+	const uint64_t count = uint64_t{ 1 } << solutions.null_basis.size();
+	for (uint64_t i = 1; i < count; ++i)
+	{
+		combination ^= solutions.null_basis[std::countr_zero(i)];
+		f(combination);
+	}
+}
@@ -0,0 +1,470 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "lp.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Exact minimum of sum(x) subject to A x = jolts, x >= 0 integer, where
+// column j of A is button j (1 for every counter it increments). The system
+// is brought into integer reduced row echelon form, the buttons without a
+// pivot are enumerated within their bounds (no button can be pressed more
+// often than the smallest counter it touches) and each pivot button follows
+// from them. Works for any number of counters and buttons.
+//
+// The search is branch and bound: before a free button is enumerated its
+// range is narrowed to the values that leave every pivot row reachable
+// (0 <= pivot <= bound) with the buttons still open, a row is checked for
+// divisibility as soon as its last free button is set, and a subtree is cut
+// when a lower bound on its total is no better than the best one so far.
+class JoltageIlp
+{
+public:
+	static constexpr size_t unreachable = std::numeric_limits<size_t>::max();
+
+	JoltageIlp(const std::vector<std::vector<size_t>>& buttons, std::span<const size_t> jolts)
+		: columns(buttons.size()), bounds(buttons.size(), 0)
+	{
+		const size_t counters = jolts.size();
+		rows.assign(counters, std::vector<int64_t>(columns + 1, 0));
+		for (size_t j = 0; j < columns; ++j)
+		{
+			size_t bound = std::numeric_limits<size_t>::max();
+			for (size_t counter : buttons[j])
+			{
+				if (counter < counters)
+				{
+					rows[counter][j] = 1;
+					bound = std::min(bound, jolts[counter]);
+				}
+			}
+			// a button that touches no counter is never worth pressing
+			bounds[j] = bound == std::numeric_limits<size_t>::max() ? 0 : static_cast<int64_t>(bound);
+		}
+		for (size_t i = 0; i < counters; ++i)
+		{
+			if (jolts[i] > static_cast<size_t>(std::numeric_limits<int64_t>::max()))
+			{
+				throw std::overflow_error("Jolt value too large for the ILP solver");
+			}
+			rows[i][columns] = static_cast<int64_t>(jolts[i]);
+		}
+		eliminate();
+		if (consistent)
+		{
+			prepare();
+		}
+	}
+
+	size_t solve()
+	{
+		if (!consistent)
+		{
+			return unreachable;
+		}
+		best = unreachable;
+		residuals.resize(rows.size());
+		for (size_t r = 0; r < rows.size(); ++r)
+		{
+			residuals[r] = rows[r][columns];
+		}
+		// the root relaxation is the largest, sizing the tableau for it once
+		// keeps the nodes below from allocating
+		relaxation.reset(free_columns.size() + 2 * rows.size(), free_columns.size());
+		enumerate(0, 0);
+		return best;
+	}
+
+private:
+	// slack for rounding errors of the floating-point relaxation
+	static constexpr double relaxation_tolerance = 1e-6;
+
+	// A free button's coefficient in one pivot row.
+	struct Entry
+	{
+		size_t row;
+		int64_t coefficient;
+	};
+
+	static int64_t checked_mul(int64_t a, int64_t b)
+	{
+#if defined(_MSC_VER)
+		int64_t high;
+		const int64_t low = _mul128(a, b, &high);
+		if (high != (low >> 63))
+		{
+			throw std::overflow_error("Integer overflow in the ILP solver");
+		}
+		return low;
+#else
+		int64_t product;
+		if (__builtin_mul_overflow(a, b, &product))
+		{
+			throw std::overflow_error("Integer overflow in the ILP solver");
+		}
+		return product;
+#endif
+	}
+
+	static int64_t checked_add(int64_t a, int64_t b)
+	{
+		if ((b > 0 && a > std::numeric_limits<int64_t>::max() - b) || (b < 0 && a < std::numeric_limits<int64_t>::min() - b))
+		{
+			throw std::overflow_error("Integer overflow in the ILP solver");
+		}
+		return a + b;
+	}
+
+	static int64_t checked_sub(int64_t a, int64_t b)
+	{
+		if ((b < 0 && a > std::numeric_limits<int64_t>::max() + b) || (b > 0 && a < std::numeric_limits<int64_t>::min() + b))
+		{
+			throw std::overflow_error("Integer overflow in the ILP solver");
+		}
+		return a - b;
+	}
+
+	// rounding divisions for a positive divisor
+	static int64_t floor_div(int64_t a, int64_t b)
+	{
+		return a / b - (a % b < 0 ? 1 : 0);
+	}
+
+	static int64_t ceil_div(int64_t a, int64_t b)
+	{
+		return a / b + (a % b > 0 ? 1 : 0);
+	}
+
+	// fraction-free Gauss-Jordan elimination, every row kept divided by the
+	// gcd of its entries
+	void eliminate()
+	{
+		size_t rank = 0;
+		std::vector<uint8_t> is_pivot(columns, 0);
+		for (size_t col = 0; col < columns && rank < rows.size(); ++col)
+		{
+			size_t pivot = rank;
+			while (pivot < rows.size() && rows[pivot][col] == 0)
+			{
+				++pivot;
+			}
+			if (pivot == rows.size())
+			{
+				continue;
+			}
+			std::swap(rows[pivot], rows[rank]);
+			for (size_t r = 0; r < rows.size(); ++r)
+			{
+				const int64_t factor = rows[r][col];
+				if (r == rank || factor == 0)
+				{
+					continue;
+				}
+				const int64_t scale = rows[rank][col];
+				for (size_t k = 0; k <= columns; ++k)
+				{
+					rows[r][k] = checked_sub(checked_mul(rows[r][k], scale), checked_mul(rows[rank][k], factor));
+				}
+				normalize(rows[r]);
+			}
+			pivot_columns.push_back(col);
+			is_pivot[col] = 1;
+			++rank;
+		}
+		for (size_t r = rank; r < rows.size(); ++r)
+		{
+			if (rows[r][columns] != 0)
+			{
+				consistent = false;
+			}
+		}
+		rows.resize(rank);
+		for (size_t col = 0; col < columns; ++col)
+		{
+			if (!is_pivot[col])
+			{
+				free_columns.push_back(col);
+			}
+		}
+	}
+
+	static void normalize(std::vector<int64_t>& row)
+	{
+		int64_t divisor = 0;
+		for (int64_t value : row)
+		{
+			divisor = std::gcd(divisor, value);
+		}
+		if (divisor > 1)
+		{
+			for (int64_t& value : row)
+			{
+				value /= divisor;
+			}
+		}
+	}
+
+	// Orders the free buttons and precomputes what enumerate needs: the
+	// reachable range of every row's residual over the still open buttons and
+	// the cost of the buttons expressed through the free ones alone.
+	void prepare()
+	{
+		const size_t count = rows.size();
+		pivot_coefficients.resize(count);
+		pivot_limits.resize(count);
+		for (size_t r = 0; r < count; ++r)
+		{
+			if (rows[r][pivot_columns[r]] < 0)
+			{
+				for (int64_t& value : rows[r])
+				{
+					value = -value;
+				}
+			}
+			pivot_coefficients[r] = rows[r][pivot_columns[r]];
+			pivot_limits[r] = checked_mul(pivot_coefficients[r], bounds[pivot_columns[r]]);
+		}
+
+		// small ranges first, ties broken towards buttons that appear in more rows
+		auto row_count = [&](size_t col)
+		{
+			return std::ranges::count_if(rows, [col](const auto& row) { return row[col] != 0; });
+		};
+		std::ranges::sort(free_columns, [&](size_t a, size_t b)
+		{
+			if (bounds[a] != bounds[b])
+			{
+				return bounds[a] < bounds[b];
+			}
+			return row_count(a) > row_count(b);
+		});
+
+		const size_t free_count = free_columns.size();
+		entries.assign(free_count, {});
+		last_free.assign(count, free_count);
+		for (size_t f = 0; f < free_count; ++f)
+		{
+			for (size_t r = 0; r < count; ++r)
+			{
+				const int64_t coefficient = rows[r][free_columns[f]];
+				if (coefficient != 0)
+				{
+					entries[f].push_back({ r, coefficient });
+					last_free[r] = f;
+				}
+			}
+		}
+
+		// rows without a free button fix their pivot once and for all
+		for (size_t r = 0; r < count; ++r)
+		{
+			if (last_free[r] == free_count)
+			{
+				const int64_t rhs = rows[r][columns];
+				if (rhs < 0 || rhs > pivot_limits[r] || rhs % pivot_coefficients[r] != 0)
+				{
+					consistent = false;
+					return;
+				}
+			}
+		}
+
+		// residual_low[f][r] .. residual_high[f][r]: what free buttons f.. can
+		// still add to the residual rhs - sum(coefficient * x) of row r
+		residual_low.assign(free_count + 1, std::vector<int64_t>(count, 0));
+		residual_high.assign(free_count + 1, std::vector<int64_t>(count, 0));
+		for (size_t f = free_count; f-- > 0;)
+		{
+			residual_low[f] = residual_low[f + 1];
+			residual_high[f] = residual_high[f + 1];
+			for (const Entry& entry : entries[f])
+			{
+				const int64_t reach = checked_mul(-entry.coefficient, bounds[free_columns[f]]);
+				auto& side = reach < 0 ? residual_low[f] : residual_high[f];
+				side[entry.row] = checked_add(side[entry.row], reach);
+			}
+		}
+		// |residual| never exceeds residual_bounds[r]; the checks below make sure
+		// the unchecked arithmetic in enumerate stays within int64_t
+		std::vector<int64_t> residual_bounds(count);
+		for (size_t r = 0; r < count; ++r)
+		{
+			residual_bounds[r] = checked_add(std::abs(rows[r][columns]), checked_sub(residual_high[0][r], residual_low[0][r]));
+			checked_mul(checked_add(residual_bounds[r], pivot_limits[r]), 4);
+		}
+
+		// total = free presses + sum(residual / pivot coefficient), so each free
+		// button costs 1 - sum(coefficient / pivot coefficient) per press
+		free_weights.assign(free_count, 1.0);
+		for (size_t f = 0; f < free_count; ++f)
+		{
+			for (const Entry& entry : entries[f])
+			{
+				free_weights[f] -= static_cast<double>(entry.coefficient) / static_cast<double>(pivot_coefficients[entry.row]);
+			}
+		}
+	}
+
+	// Minimum total of the LP relaxation below the current node: the open free
+	// buttons are real numbers within their bounds, every row they still touch
+	// must leave its pivot within 0 .. bound. Simplex::infeasible if no such
+	// point exists.
+	double relaxation_minimum(size_t index, size_t free_sum)
+	{
+		const size_t open = free_columns.size() - index;
+		size_t constraints = open;
+		for (size_t r = 0; r < rows.size(); ++r)
+		{
+			if (row_is_open(r, index))
+			{
+				constraints += 2;
+			}
+		}
+		relaxation.reset(constraints, open);
+		for (size_t j = 0; j < open; ++j)
+		{
+			relaxation.set_coefficient(j, j, 1.0);
+			relaxation.set_bound(j, static_cast<double>(bounds[free_columns[index + j]]));
+			relaxation.set_cost(j, free_weights[index + j]);
+		}
+		double constant = static_cast<double>(free_sum);
+		size_t constraint = open;
+		for (size_t r = 0; r < rows.size(); ++r)
+		{
+			constant += static_cast<double>(residuals[r]) / static_cast<double>(pivot_coefficients[r]);
+			if (!row_is_open(r, index))
+			{
+				continue;
+			}
+			for (size_t j = 0; j < open; ++j)
+			{
+				const double coefficient = static_cast<double>(rows[r][free_columns[index + j]]);
+				relaxation.set_coefficient(constraint, j, coefficient);
+				relaxation.set_coefficient(constraint + 1, j, -coefficient);
+			}
+			relaxation.set_bound(constraint, static_cast<double>(residuals[r]));
+			relaxation.set_bound(constraint + 1, static_cast<double>(pivot_limits[r] - residuals[r]));
+			constraint += 2;
+		}
+		const double minimum = relaxation.minimize();
+		return minimum == Simplex::infeasible ? minimum : constant + minimum;
+	}
+
+	// true if free buttons index.. still appear in row r
+	bool row_is_open(size_t r, size_t index) const
+	{
+		return last_free[r] != free_columns.size() && last_free[r] >= index;
+	}
+
+	void enumerate(size_t index, size_t free_sum)
+	{
+		if (index == free_columns.size())
+		{
+			size_t total = free_sum;
+			for (size_t r = 0; r < rows.size(); ++r)
+			{
+				total += static_cast<size_t>(residuals[r] / pivot_coefficients[r]);
+			}
+			best = std::min(best, total);
+			return;
+		}
+
+		// the relaxation only pays off while two or more buttons are open, the
+		// last one is narrowed exactly below
+		if (index + 1 < free_columns.size())
+		{
+			const double lowest = relaxation_minimum(index, free_sum);
+			if (lowest == Simplex::infeasible)
+			{
+				return;
+			}
+			// an improvement needs an integer total of at most best - 1
+			if (best != unreachable && lowest > static_cast<double>(best) - 1.0 + relaxation_tolerance)
+			{
+				return;
+			}
+		}
+
+		// values of this button that keep 0 <= residual <= limit reachable
+		const int64_t bound = bounds[free_columns[index]];
+		int64_t low = 0;
+		int64_t high = bound;
+		for (const Entry& entry : entries[index])
+		{
+			const size_t r = entry.row;
+			const int64_t open_low = residual_low[index + 1][r];
+			const int64_t open_high = residual_high[index + 1][r];
+			if (entry.coefficient > 0)
+			{
+				low = std::max(low, ceil_div(residuals[r] + open_low - pivot_limits[r], entry.coefficient));
+				high = std::min(high, floor_div(residuals[r] + open_high, entry.coefficient));
+			}
+			else
+			{
+				low = std::max(low, ceil_div(-(residuals[r] + open_high), -entry.coefficient));
+				high = std::min(high, floor_div(pivot_limits[r] - residuals[r] - open_low, -entry.coefficient));
+			}
+		}
+		if (low > high)
+		{
+			return;
+		}
+
+		// try the cheap end first so a good total is found early
+		const bool descending = free_weights[index] < 0;
+		for (int64_t step = 0; step <= high - low; ++step)
+		{
+			const int64_t value = descending ? high - step : low + step;
+			bool divisible = true;
+			for (const Entry& entry : entries[index])
+			{
+				residuals[entry.row] -= entry.coefficient * value;
+				if (last_free[entry.row] == index && residuals[entry.row] % pivot_coefficients[entry.row] != 0)
+				{
+					divisible = false;
+				}
+			}
+			if (divisible)
+			{
+				enumerate(index + 1, free_sum + static_cast<size_t>(value));
+			}
+			for (const Entry& entry : entries[index])
+			{
+				residuals[entry.row] += entry.coefficient * value;
+			}
+		}
+	}
+
+	size_t columns;
+	std::vector<int64_t> bounds;
+	std::vector<std::vector<int64_t>> rows{};
+	std::vector<size_t> pivot_columns{};
+	std::vector<size_t> free_columns{};
+	bool consistent{ true };
+
+	// per pivot row: pivot coefficient (> 0), coefficient * pivot bound,
+	// index of the last free button it contains
+	std::vector<int64_t> pivot_coefficients{};
+	std::vector<int64_t> pivot_limits{};
+	std::vector<size_t> last_free{};
+	// per free button, in enumeration order
+	std::vector<std::vector<Entry>> entries{};
+	std::vector<double> free_weights{};
+	std::vector<std::vector<int64_t>> residual_low{};
+	std::vector<std::vector<int64_t>> residual_high{};
+
+	std::vector<int64_t> residuals{};
+	Simplex relaxation{};
+	size_t best{ unreachable };
+};
@@ -1,20 +1,29 @@
 #pragma once
 
+#include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <span>
 #include <stdexcept>
-#include <string>
 #include <string_view>
+#include <tuple>
+#include <variant>
 #include <vector>
+#include "mapped-file.h"
+#include "state.h"
 
+// One machine. Buttons and jolts are views into the arenas of the
+// ConfigurationSet the machine was loaded into.
+template<class State>
 struct Configuration
 {
-	uint16_t curr_state{ 0 };
-	uint16_t target_state{ 0 };
-	std::vector<uint16_t> buttons;
-	std::vector<size_t> jolts{};
+	size_t lights{ 0 };
+	State curr_state{};
+	State target_state{};
+	std::span<const State> buttons{};
+	std::span<const size_t> jolts{};
 	void press_button(size_t index)
 	{
 		if (index < buttons.size())
@@ -22,42 +31,50 @@ struct Configuration
 			curr_state ^= buttons[index];
 		}
 	}
-
-	bool press_button_to_joltage(size_t index)
-	{
-		uint16_t button_mask = buttons[index];
-		for (size_t bit = 0; button_mask > 0; ++bit)
-		{
-			if ((button_mask & 1) == 1)
-			{
-				if(jolts[bit]==0)
-					return false;
-				jolts[bit]--;
-			}
-			button_mask >>= 1;
-		}
-		return true;
-	}
 };
 
+// every machine gets the narrowest state word that holds all its lights
+using AnyConfiguration = std::variant<Configuration<uint16_t>, Configuration<uint32_t>, Configuration<uint64_t>, Configuration<wide_state_t>>;
+
 using button_t = std::vector<size_t>;
-std::vector<button_t> buttons_from_configuration(const Configuration& config)
+template<class State>
+std::vector<button_t> buttons_from_configuration(const Configuration<State>& config)
 {
 	std::vector<button_t> buttons;
-	for (auto button_mask : config.buttons)
+	for (const auto& button_mask : config.buttons)
 	{
 		button_t button{};
-		for(size_t bit=0; button_mask > 0; ++bit)
-		{
-			if( (button_mask & 1) == 1)
-				button.push_back(bit);
-			button_mask >>= 1;
-		}
+		for_each_set_bit(button_mask, [&](size_t bit) { button.push_back(bit); });
 		buttons.push_back(button);	
 	}
 	return buttons;
 }
 
+// All machines of one file. Button masks (one arena per state type) and jolt
+// lists of every machine share a few contiguous arrays, the machines only
+// hold spans into them, so the set is move-only.
+class ConfigurationSet
+{
+public:
+	ConfigurationSet() = default;
+	ConfigurationSet(const ConfigurationSet&) = delete;
+	ConfigurationSet& operator=(const ConfigurationSet&) = delete;
+	ConfigurationSet(ConfigurationSet&&) noexcept = default;
+	ConfigurationSet& operator=(ConfigurationSet&&) noexcept = default;
+
+	size_t size() const { return machines.size(); }
+	const AnyConfiguration& operator[](size_t index) const { return machines[index]; }
+	auto begin() const { return machines.begin(); }
+	auto end() const { return machines.end(); }
+
+private:
+	friend ConfigurationSet load_configurations(const std::filesystem::path& path);
+
+	std::tuple<std::vector<uint16_t>, std::vector<uint32_t>, std::vector<uint64_t>, std::vector<wide_state_t>> button_arenas{};
+	std::vector<size_t> jolt_arena{};
+	std::vector<AnyConfiguration> machines{};
+};
+
 namespace loader_detail
 {
 	inline std::string_view trim(std::string_view value)
@@ -73,85 +90,82 @@ namespace loader_detail
 		return value;
 	}
 
-	inline uint16_t parse_target_pattern(std::string_view pattern)
+	// Calls f(value) for every number of a comma separated list.
+	template<class F>
+	void parse_number_list(std::string_view spec, F f)
 	{
-		if (pattern.size() > 16)
+		const char* pos = spec.data();
+		const char* const last = spec.data() + spec.size();
+		while (pos < last)
 		{
-			throw std::runtime_error("Target pattern exceeds 16 bits");
-		}
-
-		uint16_t state = 0;
-		for (size_t idx = 0; idx < pattern.size(); ++idx)
-		{
-			char ch = pattern[idx];
-			if (ch == '#')
-			{
-				state |= static_cast<uint16_t>(1u << idx);
-			}
-			else if (ch != '.')
+			while (pos < last && (*pos == ',' || std::isspace(static_cast<unsigned char>(*pos))))
 			{
-				throw std::runtime_error("Invalid character in target pattern");
+				++pos;
 			}
-		}
-		return state;
-	}
-
-	inline uint16_t parse_button_mask(std::string_view spec)
-	{
-		uint16_t mask = 0;
-		size_t start = 0;
-		while (start <= spec.size())
-		{
-			size_t next = spec.find(',', start);
-			std::string_view token = trim(spec.substr(start, next == std::string_view::npos ? spec.size() - start : next - start));
-			if (!token.empty())
+			if (pos == last)
 			{
-				int bit = std::stoi(std::string(token));
-				if (bit < 0 || bit > 15)
-				{
-					throw std::runtime_error("Button bit index out of range");
-				}
-				mask |= static_cast<uint16_t>(1u << bit);
+				break;
 			}
-			if (next == std::string_view::npos)
+			size_t value = 0;
+			const auto [end, ec] = std::from_chars(pos, last, value);
+			if (ec != std::errc{})
 			{
-				break;
+				throw std::runtime_error("Invalid number in configuration line");
 			}
-			start = next + 1;
+			f(value);
+			pos = end;
 		}
-		return mask;
 	}
 
-	inline std::vector<size_t> parse_jolts(std::string_view spec)
+	// Where one machine's data sits while the file is parsed; the spans are
+	// only created once the arenas stop growing.
+	struct MachineRecord
+	{
+		size_t button_begin;
+		size_t button_count;
+		size_t jolt_begin;
+		size_t jolt_count;
+	};
+
+	// Scratch space reused for every line: the light indices of all buttons
+	// and where each button's indices end.
+	struct LineScratch
+	{
+		std::vector<uint16_t> indices;
+		std::vector<uint32_t> button_ends;
+	};
+
+	template<class State>
+	Configuration<State> build_configuration(size_t lights, std::string_view pattern, const LineScratch& scratch, std::vector<State>& arena)
 	{
-		std::vector<size_t> jolts;
-		size_t start = 0;
-		while (start <= spec.size())
+		Configuration<State> config{};
+		config.lights = lights;
+		for (size_t idx = 0; idx < pattern.size(); ++idx)
 		{
-			size_t next = spec.find(',', start);
-			std::string_view token = trim(spec.substr(start, next == std::string_view::npos ? spec.size() - start : next - start));
-			if (!token.empty())
+			if (pattern[idx] == '#')
 			{
-				jolts.push_back(std::stoi(std::string(token)));
+				set_bit(config.target_state, idx);
 			}
-			if (next == std::string_view::npos)
+		}
+		size_t first = 0;
+		for (uint32_t end : scratch.button_ends)
+		{
+			State mask{};
+			for (size_t k = first; k < end; ++k)
 			{
-				break;
+				set_bit(mask, scratch.indices[k]);
 			}
-			start = next + 1;
+			arena.push_back(mask);
+			first = end;
 		}
-		return jolts;
+		return config;
 	}
 
-	inline Configuration parse_configuration_line(const std::string& line)
+	// Parses "[pattern] (a,b) (c) ... {j0,j1,...}". Jolts go straight into
+	// jolt_arena, button masks into the arena of the chosen state type.
+	template<class Arenas>
+	AnyConfiguration parse_configuration_line(std::string_view view, LineScratch& scratch, Arenas& button_arenas, std::vector<size_t>& jolt_arena, MachineRecord& record)
 	{
-		Configuration config{};
-		std::string_view view = trim(line);
-		if (view.empty())
-		{
-			return config;
-		}
-
 		if (view.front() != '[')
 		{
 			throw std::runtime_error("Line does not start with target pattern");
@@ -163,8 +177,20 @@ namespace loader_detail
 			throw std::runtime_error("Missing closing bracket for target pattern");
 		}
 
-		config.target_state = parse_target_pattern(view.substr(1, target_end - 1));
+		const std::string_view pattern = view.substr(1, target_end - 1);
+		if (pattern.size() > max_lights)
+		{
+			throw std::runtime_error("Target pattern exceeds 256 lights");
+		}
+		if (pattern.find_first_not_of(".#") != std::string_view::npos)
+		{
+			throw std::runtime_error("Invalid character in target pattern");
+		}
 
+		scratch.indices.clear();
+		scratch.button_ends.clear();
+		record.jolt_begin = jolt_arena.size();
+		size_t lights = pattern.size();
 		size_t pos = target_end + 1;
 		bool jolts_assigned = false;
 		while (pos < view.size())
@@ -185,7 +211,16 @@ namespace loader_detail
 				{
 					throw std::runtime_error("Missing closing parenthesis for button definition");
 				}
-				config.buttons.push_back(parse_button_mask(view.substr(pos + 1, closing - pos - 1)));
+				parse_number_list(view.substr(pos + 1, closing - pos - 1), [&](size_t bit)
+				{
+					if (bit >= max_lights)
+					{
+						throw std::runtime_error("Button bit index out of range");
+					}
+					scratch.indices.push_back(static_cast<uint16_t>(bit));
+					lights = std::max(lights, bit + 1);
+				});
+				scratch.button_ends.push_back(static_cast<uint32_t>(scratch.indices.size()));
 				pos = closing + 1;
 			}
 			else if (view[pos] == '{')
@@ -195,7 +230,8 @@ namespace loader_detail
 				{
 					throw std::runtime_error("Missing closing brace for jolt list");
 				}
-				config.jolts = parse_jolts(view.substr(pos + 1, closing - pos - 1));
+				jolt_arena.resize(record.jolt_begin);
+				parse_number_list(view.substr(pos + 1, closing - pos - 1), [&](size_t jolt) { jolt_arena.push_back(jolt); });
 				jolts_assigned = true;
 				pos = closing + 1;
 			}
@@ -209,31 +245,78 @@ namespace loader_detail
 		{
 			throw std::runtime_error("Jolt list missing in configuration line");
 		}
+		record.jolt_count = jolt_arena.size() - record.jolt_begin;
+		record.button_count = scratch.button_ends.size();
 
-		return config;
+		lights = std::max(lights, record.jolt_count);
+		if (lights > max_lights)
+		{
+			throw std::runtime_error("Machine exceeds 256 lights");
+		}
+		auto build = [&]<class State>(std::vector<State>& arena) -> AnyConfiguration
+		{
+			record.button_begin = arena.size();
+			return build_configuration<State>(lights, pattern, scratch, arena);
+		};
+		if (lights <= 16)
+		{
+			return build(std::get<std::vector<uint16_t>>(button_arenas));
+		}
+		if (lights <= 32)
+		{
+			return build(std::get<std::vector<uint32_t>>(button_arenas));
+		}
+		if (lights <= 64)
+		{
+			return build(std::get<std::vector<uint64_t>>(button_arenas));
+		}
+		return build(std::get<std::vector<wide_state_t>>(button_arenas));
 	}
 }
 
-inline std::vector<Configuration> load_configurations(const std::filesystem::path& path)
+// Reads all machines from a memory-mapped file. Numbers are parsed with
+// std::from_chars straight from the mapping; apart from the arenas, which
+// are reserved from a quick count up front, and a scratch buffer reused for
+// every line, nothing is allocated per machine or token.
+inline ConfigurationSet load_configurations(const std::filesystem::path& path)
 {
-	std::ifstream input(path);
-	if (!input)
-	{
-		throw std::runtime_error("Unable to open configuration file");
-	}
+	const tools::MappedFile file(path);
+	std::string_view text = file.view();
+
+	ConfigurationSet set;
+	const size_t line_count = static_cast<size_t>(std::ranges::count(text, '\n')) + 1;
+	const size_t button_count = static_cast<size_t>(std::ranges::count(text, '('));
+	const size_t number_count = static_cast<size_t>(std::ranges::count(text, ',')) + button_count + line_count;
+	set.machines.reserve(line_count);
+	std::get<std::vector<uint16_t>>(set.button_arenas).reserve(button_count);
+	set.jolt_arena.reserve(number_count - button_count);
 
-	std::vector<Configuration> configurations;
-	std::string line;
-	while (std::getline(input, line))
+	std::vector<loader_detail::MachineRecord> records;
+	records.reserve(line_count);
+	loader_detail::LineScratch scratch;
+	while (!text.empty())
 	{
-		std::string_view trimmed = loader_detail::trim(line);
-		if (trimmed.empty())
+		const size_t eol = text.find('\n');
+		const std::string_view line = loader_detail::trim(text.substr(0, eol));
+		text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+		if (line.empty())
 		{
 			continue;
 		}
-
-		configurations.push_back(loader_detail::parse_configuration_line(line));
+		loader_detail::MachineRecord record{};
+		set.machines.push_back(loader_detail::parse_configuration_line(line, scratch, set.button_arenas, set.jolt_arena, record));
+		records.push_back(record);
 	}
 
-	return configurations;
+	for (size_t i = 0; i < set.machines.size(); ++i)
+	{
+		const auto& record = records[i];
+		std::visit([&]<class State>(Configuration<State>& config)
+		{
+			const auto& arena = std::get<std::vector<State>>(set.button_arenas);
+			config.buttons = std::span<const State>(arena).subspan(record.button_begin, record.button_count);
+			config.jolts = std::span<const size_t>(set.jolt_arena).subspan(record.jolt_begin, record.jolt_count);
+		}, set.machines[i]);
+	}
+	return set;
 }
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Dense tableau simplex for min c.x subject to A x <= b, x >= 0. A negative
+// right-hand side is handled by a first phase with one artificial variable.
+// Pivots follow Bland's rule: the entering variable is the lowest-indexed one
+// with a negative reduced cost, ratio-test ties go to the lowest-indexed basic
+// variable, so the degenerate relaxations of the joltage ILP (many zero
+// bounds) cannot cycle. The tableau is reused between problems: reset() keeps
+// its storage, so one instance serves a whole branch-and-bound search.
+class Simplex
+{
+public:
+	static constexpr double infeasible = std::numeric_limits<double>::infinity();
+	static constexpr double unbounded = -std::numeric_limits<double>::infinity();
+
+	// starts a problem with the given shape, A, b and c all zero
+	void reset(size_t constraints, size_t variables)
+	{
+		m = constraints;
+		n = variables;
+		width = n + 2;
+		table.assign((m + 2) * width, 0.0);
+		basic.resize(m);
+		nonbasic.resize(n + 1);
+		for (size_t i = 0; i < m; ++i)
+		{
+			basic[i] = static_cast<int>(n + i);
+			at(i, n) = -1.0;
+		}
+		for (size_t j = 0; j < n; ++j)
+		{
+			nonbasic[j] = static_cast<int>(j);
+		}
+		nonbasic[n] = artificial;
+		at(m + 1, n) = 1.0;
+	}
+
+	void set_coefficient(size_t constraint, size_t variable, double value) { at(constraint, variable) = value; }
+	void set_bound(size_t constraint, double value) { at(constraint, n + 1) = value; }
+	// row m holds the reduced costs of max (-c).x
+	void set_cost(size_t variable, double value) { at(m, variable) = value; }
+
+	// minimum of c.x, infeasible or unbounded if there is none
+	double minimize()
+	{
+		if (m > 0)
+		{
+			size_t lowest = 0;
+			for (size_t i = 1; i < m; ++i)
+			{
+				if (at(i, n + 1) < at(lowest, n + 1))
+				{
+					lowest = i;
+				}
+			}
+			if (at(lowest, n + 1) < -epsilon)
+			{
+				// phase 1: bring the artificial variable in, then drive it out
+				pivot(lowest, n);
+				if (!optimize(m + 1) || at(m + 1, n + 1) < -epsilon)
+				{
+					return infeasible;
+				}
+				for (size_t i = 0; i < m; ++i)
+				{
+					if (basic[i] == artificial)
+					{
+						size_t entering = 0;
+						for (size_t j = 1; j <= n; ++j)
+						{
+							if (at(i, j) < at(i, entering) || (at(i, j) == at(i, entering) && nonbasic[j] < nonbasic[entering]))
+							{
+								entering = j;
+							}
+						}
+						pivot(i, entering);
+					}
+				}
+			}
+		}
+		if (!optimize(m))
+		{
+			return unbounded;
+		}
+		return -at(m, n + 1);
+	}
+
+private:
+	static constexpr int artificial = -1;
+	static constexpr double epsilon = 1e-9;
+
+	double& at(size_t row, size_t column) { return table[row * width + column]; }
+
+	void pivot(size_t r, size_t s)
+	{
+		const double inverse = 1.0 / at(r, s);
+		for (size_t i = 0; i < m + 2; ++i)
+		{
+			if (i == r || at(i, s) == 0.0)
+			{
+				continue;
+			}
+			const double factor = at(i, s) * inverse;
+			for (size_t j = 0; j < width; ++j)
+			{
+				if (j != s)
+				{
+					at(i, j) -= at(r, j) * factor;
+				}
+			}
+			at(i, s) = -factor;
+		}
+		for (size_t j = 0; j < width; ++j)
+		{
+			if (j != s)
+			{
+				at(r, j) *= inverse;
+			}
+		}
+		at(r, s) = inverse;
+		std::swap(basic[r], nonbasic[s]);
+	}
+
+	// runs the simplex on objective row `objective`, false if it is unbounded
+	bool optimize(size_t objective)
+	{
+		const bool phase_one = objective == m + 1;
+		while (true)
+		{
+			size_t entering = n + 1;
+			for (size_t j = 0; j <= n; ++j)
+			{
+				if (!phase_one && nonbasic[j] == artificial)
+				{
+					continue;
+				}
+				if (at(objective, j) < -epsilon && (entering == n + 1 || nonbasic[j] < nonbasic[entering]))
+				{
+					entering = j;
+				}
+			}
+			if (entering == n + 1)
+			{
+				return true;
+			}
+			size_t leaving = m;
+			double smallest = 0.0;
+			for (size_t i = 0; i < m; ++i)
+			{
+				if (at(i, entering) < epsilon)
+				{
+					continue;
+				}
+				const double ratio = at(i, n + 1) / at(i, entering);
+				const bool first = leaving == m;
+				if (first || ratio < smallest - epsilon || (ratio <= smallest + epsilon && basic[i] < basic[leaving]))
+				{
+					smallest = first ? ratio : std::min(smallest, ratio);
+					leaving = i;
+				}
+			}
+			if (leaving == m)
+			{
+				return false;
+			}
+			pivot(leaving, entering);
+		}
+	}
+
+	size_t m{ 0 };
+	size_t n{ 0 };
+	size_t width{ 2 };
+	std::vector<int> basic{};
+	std::vector<int> nonbasic{};
+	std::vector<double> table{};
+};
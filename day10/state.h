@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+// Light and button state words. Machines with up to 64 lights use a plain
+// unsigned word, larger ones a fixed number of 64-bit words.
+template<size_t Words>
+struct WideState
+{
+	std::array<uint64_t, Words> words{};
+
+	WideState& operator^=(const WideState& other)
+	{
+		for (size_t w = 0; w < Words; ++w)
+		{
+			words[w] ^= other.words[w];
+		}
+		return *this;
+	}
+	bool operator==(const WideState&) const = default;
+};
+
+constexpr size_t max_lights = 256;
+using wide_state_t = WideState<max_lights / 64>;
+
+template<std::unsigned_integral Word>
+bool test_bit(Word state, size_t bit)
+{
+	return ((state >> bit) & 1) != 0;
+}
+
+template<std::unsigned_integral Word>
+void set_bit(Word& state, size_t bit)
+{
+	state |= static_cast<Word>(Word{ 1 } << bit);
+}
+
+template<size_t Words>
+bool test_bit(const WideState<Words>& state, size_t bit)
+{
+	return ((state.words[bit / 64] >> (bit % 64)) & 1) != 0;
+}
+
+template<size_t Words>
+void set_bit(WideState<Words>& state, size_t bit)
+{
+	state.words[bit / 64] |= uint64_t{ 1 } << (bit % 64);
+}
+
+// calls f(bit) for every set bit, lowest first
+template<std::unsigned_integral Word, class F>
+void for_each_set_bit(Word state, F f)
+{
+	for (uint64_t rest = state; rest != 0; rest &= rest - 1)
+	{
+		f(static_cast<size_t>(std::countr_zero(rest)));
+	}
+}
+
+template<size_t Words, class F>
+void for_each_set_bit(const WideState<Words>& state, F f)
+{
+	for (size_t w = 0; w < Words; ++w)
+	{
+		for (uint64_t rest = state.words[w]; rest != 0; rest &= rest - 1)
+		{
+			f(w * 64 + static_cast<size_t>(std::countr_zero(rest)));
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#include "condensation.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr uint32_t unvisited = std::numeric_limits<uint32_t>::max();
+
+// Tarjan's algorithm with an explicit call stack so deep networks cannot
+// overflow the native one. Components are emitted in reverse topological
+// order; the returned ids are already flipped into topological order.
+std::vector<uint32_t> find_components(const Network& network, uint32_t& count)
+{
+    const size_t n = network.size();
+    std::vector<uint32_t> index(n, unvisited);
+    std::vector<uint32_t> low(n, 0);
+    std::vector<uint8_t> on_stack(n, 0);
+    std::vector<node_id> stack;
+    std::vector<uint32_t> emitted(n, 0);
+
+    struct Frame {
+        node_id node;
+        uint32_t next_edge;
+    };
+    std::vector<Frame> frames;
+    uint32_t next_index = 0;
+    count = 0;
+
+    auto enter = [&](node_id node) {
+        index[node] = low[node] = next_index++;
+        stack.push_back(node);
+        on_stack[node] = 1;
+        frames.push_back({ node, 0 });
+    };
+
+    for (node_id root = 0; root < n; ++root)
+    {
+        if (index[root] != unvisited)
+            continue;
+        enter(root);
+        while (!frames.empty())
+        {
+            const node_id node = frames.back().node;
+            const auto successors = network.successors(node);
+            if (frames.back().next_edge < successors.size())
+            {
+                const node_id next = successors[frames.back().next_edge++];
+                if (index[next] == unvisited)
+                    enter(next);
+                else if (on_stack[next])
+                    low[node] = std::min(low[node], index[next]);
+                continue;
+            }
+
+            if (low[node] == index[node])
+            {
+                node_id member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = 0;
+                    emitted[member] = count;
+                } while (member != node);
+                ++count;
+            }
+            frames.pop_back();
+            if (!frames.empty())
+            {
+                const node_id parent = frames.back().node;
+                low[parent] = std::min(low[parent], low[node]);
+            }
+        }
+    }
+
+    for (auto& id : emitted)
+        id = count - 1 - id;
+    return emitted;
+}
+} // namespace
+
+Condensation::Condensation(const Network& network)
+{
+    uint32_t count = 0;
+    component_ = find_components(network, count);
+    cyclic_.assign(count, 0);
+
+    member_offsets_.assign(count + 1, 0);
+    offsets_.assign(count + 1, 0);
+    for (node_id node = 0; node < network.size(); ++node)
+    {
+        const uint32_t from = component_[node];
+        ++member_offsets_[from + 1];
+        for (node_id next : network.successors(node))
+        {
+            if (component_[next] != from)
+                ++offsets_[from + 1];
+            else if (next == node)
+                cyclic_[from] = 1;
+        }
+    }
+    for (uint32_t c = 0; c < count; ++c)
+    {
+        member_offsets_[c + 1] += member_offsets_[c];
+        offsets_[c + 1] += offsets_[c];
+        if (member_offsets_[c + 1] - member_offsets_[c] > 1)
+            cyclic_[c] = 1;
+    }
+
+    members_.resize(network.size());
+    targets_.resize(offsets_[count]);
+    std::vector<uint32_t> member_fill(member_offsets_.begin(), member_offsets_.end() - 1);
+    std::vector<uint32_t> edge_fill(offsets_.begin(), offsets_.end() - 1);
+    for (node_id node = 0; node < network.size(); ++node)
+    {
+        const uint32_t from = component_[node];
+        members_[member_fill[from]++] = node;
+        for (node_id next : network.successors(node))
+            if (component_[next] != from)
+                targets_[edge_fill[from]++] = component_[next];
+    }
+}
+
+std::vector<uint32_t> Condensation::cycles() const
+{
+    std::vector<uint32_t> result;
+    for (uint32_t c = 0; c < size(); ++c)
+        if (is_cyclic(c))
+            result.push_back(c);
+    return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "network.h"
+
+// Strongly connected components of a network and the DAG between them.
+// Components are numbered in topological order, so every edge of the DAG
+// points from a lower to a higher component id and a path-counting pass can
+// simply walk the ids. Edges keep their multiplicity; edges inside a
+// component are dropped. A component is cyclic when it has more than one
+// node or a self-loop, i.e. a path entering it can go round arbitrarily often.
+class Condensation {
+public:
+    explicit Condensation(const Network& network);
+
+    size_t size() const { return cyclic_.size(); }
+    uint32_t component(node_id node) const { return component_[node]; }
+    bool is_cyclic(uint32_t component) const { return cyclic_[component] != 0; }
+
+    std::span<const uint32_t> successors(uint32_t component) const {
+        return { targets_.data() + offsets_[component], targets_.data() + offsets_[component + 1] };
+    }
+    std::span<const node_id> members(uint32_t component) const {
+        return { members_.data() + member_offsets_[component], members_.data() + member_offsets_[component + 1] };
+    }
+
+    // ids of all cyclic components
+    std::vector<uint32_t> cycles() const;
+
+private:
+    std::vector<uint32_t> component_{};
+    std::vector<uint8_t> cyclic_{};
+    std::vector<uint32_t> offsets_{};
+    std::vector<uint32_t> targets_{};
+    std::vector<uint32_t> member_offsets_{};
+    std::vector<node_id> members_{};
+};
@@ -0,0 +1,86 @@
+#include "network.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace {
+std::string trim(const std::string& value)
+{
+    auto first = std::find_if_not(value.begin(), value.end(), [](unsigned char ch) { return std::isspace(ch); });
+    auto last = std::find_if_not(value.rbegin(), value.rend(), [](unsigned char ch) { return std::isspace(ch); }).base();
+    if (first >= last)
+        return {};
+    return { first, last };
+}
+} // namespace
+
+node_id Network::find(std::string_view name) const
+{
+    auto it = ids_.find(std::string(name));
+    return it == ids_.end() ? no_node : it->second;
+}
+
+Network load_network(const std::vector<std::string>& lines)
+{
+    Network network;
+    auto intern = [&network](const std::string& name) {
+        auto [it, inserted] = network.ids_.try_emplace(name, static_cast<node_id>(network.names_.size()));
+        if (inserted)
+            network.names_.push_back(name);
+        return it->second;
+    };
+
+    // adjacency per node while parsing, a repeated key replaces the earlier line
+    std::vector<std::vector<node_id>> adjacency;
+    for (const auto& raw_line : lines)
+    {
+        if (raw_line.empty())
+            continue;
+
+        auto colon_pos = raw_line.find(':');
+        if (colon_pos == std::string::npos)
+            continue; // Ignore malformed lines without delimiter
+
+        std::string key = trim(raw_line.substr(0, colon_pos));
+        if (key.empty())
+            continue;
+
+        const node_id source = intern(key);
+        std::vector<node_id> connections;
+        std::istringstream iss(raw_line.substr(colon_pos + 1));
+        std::string node;
+        while (iss >> node)
+            connections.push_back(intern(node));
+
+        if (adjacency.size() < network.size())
+            adjacency.resize(network.size());
+        adjacency[source] = std::move(connections);
+    }
+    adjacency.resize(network.size());
+
+    network.offsets_.assign(1, 0);
+    network.offsets_.reserve(network.size() + 1);
+    for (const auto& connections : adjacency)
+    {
+        network.targets_.insert(network.targets_.end(), connections.begin(), connections.end());
+        network.offsets_.push_back(static_cast<uint32_t>(network.targets_.size()));
+    }
+    return network;
+}
+
+bool load_network_from_file(const std::string& file_path, Network& network)
+{
+    std::ifstream input(file_path);
+    if (!input)
+        return false;
+
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(input, line))
+        lines.push_back(line);
+
+    network = load_network(lines);
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using node_id = uint32_t;
+constexpr node_id no_node = std::numeric_limits<node_id>::max();
+
+// Directed device network. Node names are interned into dense ids in order of
+// first appearance, the edges are kept in compressed sparse row form: the
+// successors of node n are targets[offsets[n] .. offsets[n + 1]).
+class Network {
+public:
+    size_t size() const { return names_.size(); }
+    size_t edge_count() const { return targets_.size(); }
+
+    // id of the named node, no_node if the name never appeared
+    node_id find(std::string_view name) const;
+    const std::string& name(node_id node) const { return names_[node]; }
+
+    std::span<const node_id> successors(node_id node) const {
+        return { targets_.data() + offsets_[node], targets_.data() + offsets_[node + 1] };
+    }
+
+    friend Network load_network(const std::vector<std::string>& lines);
+
+private:
+    std::vector<std::string> names_{};
+    std::unordered_map<std::string, node_id> ids_{};
+    std::vector<uint32_t> offsets_{ 0 };
+    std::vector<node_id> targets_{};
+};
+
+// parses "name: target target ..." lines, lines without ':' are ignored
+Network load_network(const std::vector<std::string>& lines);
+bool load_network_from_file(const std::string& file_path, Network& network);
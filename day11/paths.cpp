@@ -0,0 +1,74 @@
+#include "paths.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+template<class Count>
+PathCounts<Count> paths_from(const Condensation& condensation, node_id source)
+{
+    std::vector<PathCount<Count>> counts(condensation.size());
+    if (source == no_node)
+        return { condensation, std::move(counts) };
+    const uint32_t first = condensation.component(source);
+    counts[first].ways = Count(1);
+    for (uint32_t c = first; c < condensation.size(); ++c)
+    {
+        if (!counts[c].any())
+            continue;
+        if (condensation.is_cyclic(c))
+            counts[c].unbounded = true;
+        for (uint32_t next : condensation.successors(c))
+            counts[next] = counts[next] + counts[c];
+    }
+    return { condensation, std::move(counts) };
+}
+
+template<class Count>
+PathCount<Count> count_paths(const Condensation& condensation, node_id src, node_id dst, std::span<const node_id> required_nodes)
+{
+    if (required_nodes.size() > max_required_nodes)
+        throw std::invalid_argument("count_paths supports at most 16 required nodes");
+    if (src == no_node || dst == no_node || std::ranges::find(required_nodes, no_node) != required_nodes.end())
+        return {};
+
+    // waypoints that lie in each component; a cyclic component holding
+    // several of them lets a path collect all of them on one visit
+    std::vector<uint32_t> component_bits(condensation.size(), 0);
+    for (size_t bit = 0; bit < required_nodes.size(); ++bit)
+        component_bits[condensation.component(required_nodes[bit])] |= uint32_t{ 1 } << bit;
+
+    const size_t masks = size_t{ 1 } << required_nodes.size();
+    const uint32_t all_seen = static_cast<uint32_t>(masks - 1);
+    const uint32_t first = condensation.component(src);
+    const uint32_t last = condensation.component(dst);
+    if (last < first)
+        return {};
+
+    // counts[c * masks + m]: paths from src into component c that have seen the waypoints in m
+    std::vector<PathCount<Count>> counts((last - first + 1) * masks);
+    auto at = [&](uint32_t c, uint32_t m) -> PathCount<Count>& { return counts[(c - first) * masks + m]; };
+    at(first, component_bits[first]).ways = Count(1);
+    for (uint32_t c = first; c < last; ++c)
+    {
+        for (uint32_t m = 0; m < masks; ++m)
+        {
+            PathCount<Count>& here = at(c, m);
+            if (!here.any())
+                continue;
+            if (condensation.is_cyclic(c))
+                here.unbounded = true;
+            for (uint32_t next : condensation.successors(c))
+                if (next <= last)
+                    at(next, m | component_bits[next]) = at(next, m | component_bits[next]) + here;
+        }
+    }
+    PathCount<Count> result = at(last, all_seen);
+    if (result.any() && condensation.is_cyclic(last))
+        result.unbounded = true;
+    return result;
+}
+
+template PathCounts<uint64_t> paths_from<uint64_t>(const Condensation&, node_id);
+template PathCounts<wide_count_t> paths_from<wide_count_t>(const Condensation&, node_id);
+template PathCount<uint64_t> count_paths<uint64_t>(const Condensation&, node_id, node_id, std::span<const node_id>);
+template PathCount<wide_count_t> count_paths<wide_count_t>(const Condensation&, node_id, node_id, std::span<const node_id>);
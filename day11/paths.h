@@ -0,0 +1,101 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "condensation.h"
+#include "long-int.h"
+#include "network.h"
+
+// Number of paths between two nodes, counted in Count (uint64_t or a wider
+// type such as tools::LongInt256). A path that can pass through a cyclic
+// component can be extended without limit, the count is then unbounded
+// instead of a number. overflow is set when a built-in unsigned Count wrapped
+// somewhere on the way to this value.
+template<class Count>
+struct PathCount {
+    Count ways{};
+    bool unbounded = false;
+    bool overflow = false;
+
+    bool any() const { return unbounded || overflow || ways != Count{}; }
+};
+
+namespace detail {
+    // into += value, true if that wrapped around
+    template<class Count>
+    bool add_ways(Count& into, const Count& value) {
+        into = into + value;
+        if constexpr (std::unsigned_integral<Count>) {
+            return into < value;
+        }
+        return false;
+    }
+}
+
+template<class Count>
+PathCount<Count> operator+(PathCount<Count> lhs, const PathCount<Count>& rhs)
+{
+    const bool wrapped = detail::add_ways(lhs.ways, rhs.ways);
+    lhs.unbounded = lhs.unbounded || rhs.unbounded;
+    lhs.overflow = lhs.overflow || rhs.overflow || wrapped;
+    return lhs;
+}
+
+template<class Count>
+std::ostream& operator<<(std::ostream& os, const PathCount<Count>& count)
+{
+    if (count.unbounded)
+        return os << "unbounded (cycle on the way)";
+    if (count.overflow)
+        return os << "overflow";
+    return os << count.ways;
+}
+
+// Path counts from one source to every node, stored per component of the
+// condensation.
+template<class Count>
+class PathCounts {
+public:
+    PathCounts(const Condensation& condensation, std::vector<PathCount<Count>> counts)
+        : condensation_(&condensation), counts_(std::move(counts)) {}
+
+    // count for the given node, nothing for nodes missing from the network
+    PathCount<Count> operator[](node_id node) const {
+        return node == no_node ? PathCount<Count>{} : counts_[condensation_->component(node)];
+    }
+
+private:
+    const Condensation* condensation_;
+    std::vector<PathCount<Count>> counts_;
+};
+
+// one sweep along the component order
+template<class Count = uint64_t>
+PathCounts<Count> paths_from(const Condensation& condensation, node_id source);
+
+// Number of paths from src to dst that visit every node of required_nodes, in
+// any order. The DP state is (component, bitmask of waypoints seen so far),
+// so one sweep costs O((V + E) * 2^k) for k waypoints; at most 16 are
+// supported. A required node missing from the network allows no path.
+constexpr size_t max_required_nodes = 16;
+template<class Count = uint64_t>
+PathCount<Count> count_paths(const Condensation& condensation, node_id src, node_id dst, std::span<const node_id> required_nodes);
+
+// paths.cpp instantiates the counting functions for uint64_t and this type
+using wide_count_t = tools::LongInt256;
+
+// Runs query with uint64_t counts and, only if that overflowed, once more with
+// wide_count_t. query is called with a std::type_identity<Count> tag and has to
+// return a PathCount<Count>.
+template<class Query>
+PathCount<wide_count_t> count_with_promotion(Query query)
+{
+    const PathCount<uint64_t> fast = query(std::type_identity<uint64_t>{});
+    if (!fast.overflow)
+        return { wide_count_t(fast.ways), fast.unbounded, false };
+    return query(std::type_identity<wide_count_t>{});
+}
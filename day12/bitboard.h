@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+#include "hash.h"
+#include "matrix.h"
+
+// Offset of a filled cell from the top-left corner of its orientation.
+struct CellOffset {
+    uint32_t row{};
+    uint32_t col{};
+};
+
+// One shape orientation as row bitmasks: bit c of rows[r] is set when cell
+// (r, c) is filled. Shapes are at most 64 cells wide. rows and offsets point
+// into the owning ShapeOrientations; offsets lists the filled cells in
+// row-major order, so (first_row, first_col) is offsets[0].
+struct ShapeMask {
+    size_t width{};
+    size_t height{};
+    size_t cells{};
+    const uint64_t* rows{};
+    const CellOffset* offsets{};
+    size_t first_row{};
+    size_t first_col{};
+};
+
+// The distinct orientations (rotations and reflections) of a shape. The eight
+// symmetries of the square are applied directly to the filled cells, and
+// duplicates are dropped by comparing the resulting masks. Row masks and cell
+// offsets of all orientations share two flat arrays, the records themselves
+// sit in a third, so a solver can scan them without chasing per-orientation
+// allocations. Orientation 0 is always the shape as given.
+class ShapeOrientations {
+public:
+    ShapeOrientations() = default;
+
+    explicit ShapeOrientations(const tools::CharMatrix& shape) {
+        const size_t height = shape.num_rows();
+        const size_t width = shape.num_cols();
+        if (width > 64 || height > 64) {
+            throw std::runtime_error("Shapes larger than 64 cells in either direction are not supported");
+        }
+        std::vector<CellOffset> base;
+        for (size_t r = 0; r < height; ++r) {
+            for (size_t c = 0; c < width; ++c) {
+                if (shape.at_unchecked(r, c) != '.') {
+                    base.push_back({ static_cast<uint32_t>(r), static_cast<uint32_t>(c) });
+                }
+            }
+        }
+
+        // (swap axes, mirror rows, mirror columns) of the eight symmetries:
+        // the four clockwise rotations, then the same after a horizontal flip
+        struct Symmetry {
+            bool transpose;
+            bool flip_rows;
+            bool flip_cols;
+        };
+        constexpr Symmetry symmetries[8] = {
+            { false, false, false }, { true, false, true }, { false, true, true }, { true, true, false },
+            { false, false, true }, { true, true, true }, { false, true, false }, { true, false, false },
+        };
+
+        struct Placement {
+            size_t width;
+            size_t height;
+            size_t row_begin;
+            size_t cell_begin;
+        };
+        std::vector<Placement> placements;
+        std::vector<uint64_t> candidate;
+        std::vector<CellOffset> cells;
+        for (const Symmetry& sym : symmetries) {
+            const size_t w = sym.transpose ? height : width;
+            const size_t h = sym.transpose ? width : height;
+            candidate.assign(h, 0);
+            for (const CellOffset cell : base) {
+                size_t r = sym.transpose ? cell.col : cell.row;
+                size_t c = sym.transpose ? cell.row : cell.col;
+                if (sym.flip_rows) {
+                    r = h - 1 - r;
+                }
+                if (sym.flip_cols) {
+                    c = w - 1 - c;
+                }
+                candidate[r] |= uint64_t{ 1 } << c;
+            }
+            const bool duplicate = std::any_of(placements.begin(), placements.end(), [&](const Placement& p) {
+                return p.width == w && p.height == h
+                    && std::equal(candidate.begin(), candidate.end(), rows_.begin() + p.row_begin);
+            });
+            if (duplicate) {
+                continue;
+            }
+
+            placements.push_back({ w, h, rows_.size(), cells_.size() });
+            rows_.insert(rows_.end(), candidate.begin(), candidate.end());
+            for (size_t r = 0; r < h; ++r) {
+                for (uint64_t bits = candidate[r]; bits != 0; bits &= bits - 1) {
+                    cells_.push_back({ static_cast<uint32_t>(r), static_cast<uint32_t>(std::countr_zero(bits)) });
+                }
+            }
+        }
+
+        masks_.reserve(placements.size());
+        for (const Placement& p : placements) {
+            ShapeMask mask{ p.width, p.height, base.size() };
+            mask.rows = rows_.data() + p.row_begin;
+            mask.offsets = cells_.data() + p.cell_begin;
+            if (!base.empty()) {
+                mask.first_row = mask.offsets[0].row;
+                mask.first_col = mask.offsets[0].col;
+            }
+            masks_.push_back(mask);
+        }
+    }
+
+    // the records point into rows_ and cells_, so a copy has to rebase them
+    ShapeOrientations(const ShapeOrientations& other)
+        : rows_(other.rows_), cells_(other.cells_), masks_(other.masks_) {
+        for (ShapeMask& mask : masks_) {
+            mask.rows = rows_.data() + (mask.rows - other.rows_.data());
+            mask.offsets = cells_.data() + (mask.offsets - other.cells_.data());
+        }
+    }
+
+    ShapeOrientations(ShapeOrientations&&) noexcept = default;
+
+    ShapeOrientations& operator=(ShapeOrientations other) noexcept {
+        rows_.swap(other.rows_);
+        cells_.swap(other.cells_);
+        masks_.swap(other.masks_);
+        return *this;
+    }
+
+    size_t size() const { return masks_.size(); }
+    bool empty() const { return masks_.empty(); }
+    const ShapeMask& operator[](size_t i) const { return masks_[i]; }
+    const ShapeMask& front() const { return masks_.front(); }
+    auto begin() const { return masks_.begin(); }
+    auto end() const { return masks_.end(); }
+
+private:
+    std::vector<uint64_t> rows_{};
+    std::vector<CellOffset> cells_{};
+    std::vector<ShapeMask> masks_{};
+};
+
+// Occupancy of a region, one bit per cell. Rows wider than 64 cells are
+// split over several words. Placing a shape ORs its row masks into the
+// region, removing it clears the same bits again, so a search can place and
+// undo in place instead of copying the region.
+class BitRegion {
+public:
+    BitRegion(size_t width, size_t height)
+        : width_(width), height_(height), words_per_row_((width + 63) / 64), bits_(words_per_row_ * height, 0) {}
+
+    size_t width() const { return width_; }
+    size_t height() const { return height_; }
+    size_t area() const { return width_ * height_; }
+    size_t filled() const { return filled_; }
+    const std::vector<uint64_t>& words() const { return bits_; }
+
+    bool test(size_t r, size_t c) const {
+        return (bits_[r * words_per_row_ + c / 64] >> (c % 64)) & 1;
+    }
+
+    // marks a single cell as used, e.g. a cell that is deliberately left empty
+    void set_cell(size_t r, size_t c) {
+        bits_[r * words_per_row_ + c / 64] |= uint64_t{ 1 } << (c % 64);
+        ++filled_;
+    }
+
+    void clear_cell(size_t r, size_t c) {
+        bits_[r * words_per_row_ + c / 64] &= ~(uint64_t{ 1 } << (c % 64));
+        --filled_;
+    }
+
+    // row-major index (r * width + c) of the first unused cell at or after
+    // index from, area() if there is none
+    size_t first_empty(size_t from) const {
+        if (width_ == 0) {
+            return area();
+        }
+        for (size_t r = from / width_; r < height_; ++r) {
+            const size_t start_col = r == from / width_ ? from % width_ : 0;
+            for (size_t w = start_col / 64; w < words_per_row_; ++w) {
+                uint64_t free_bits = ~bits_[r * words_per_row_ + w];
+                if (w == start_col / 64) {
+                    free_bits &= ~uint64_t{ 0 } << (start_col % 64);
+                }
+                const size_t valid = std::min<size_t>(64, width_ - w * 64);
+                if (valid < 64) {
+                    free_bits &= (uint64_t{ 1 } << valid) - 1;
+                }
+                if (free_bits != 0) {
+                    return r * width_ + w * 64 + static_cast<size_t>(std::countr_zero(free_bits));
+                }
+            }
+        }
+        return area();
+    }
+
+    // (region_row & (shape_row << left)) == 0 for every shape row
+    bool can_place(const ShapeMask& shape, size_t top, size_t left) const {
+        if (top + shape.height > height_ || left + shape.width > width_) {
+            return false;
+        }
+        const size_t word = left / 64;
+        const unsigned shift = static_cast<unsigned>(left % 64);
+        for (size_t r = 0; r < shape.height; ++r) {
+            const uint64_t* row = bits_.data() + (top + r) * words_per_row_ + word;
+            if ((row[0] & (shape.rows[r] << shift)) != 0) {
+                return false;
+            }
+            if (shift != 0) {
+                const uint64_t spill = shape.rows[r] >> (64 - shift);
+                if (spill != 0 && (row[1] & spill) != 0) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void place(const ShapeMask& shape, size_t top, size_t left) {
+        apply(shape, top, left, [](uint64_t& w, uint64_t m) { w |= m; });
+        filled_ += shape.cells;
+    }
+
+    // undo of place()
+    void remove(const ShapeMask& shape, size_t top, size_t left) {
+        apply(shape, top, left, [](uint64_t& w, uint64_t m) { w &= ~m; });
+        filled_ -= shape.cells;
+    }
+
+    friend bool operator==(const BitRegion& lhs, const BitRegion& rhs) {
+        return lhs.width_ == rhs.width_ && lhs.height_ == rhs.height_ && lhs.bits_ == rhs.bits_;
+    }
+
+private:
+    template<class Op>
+    void apply(const ShapeMask& shape, size_t top, size_t left, Op op) {
+        const size_t word = left / 64;
+        const unsigned shift = static_cast<unsigned>(left % 64);
+        for (size_t r = 0; r < shape.height; ++r) {
+            uint64_t* row = bits_.data() + (top + r) * words_per_row_ + word;
+            op(row[0], shape.rows[r] << shift);
+            if (shift != 0) {
+                const uint64_t spill = shape.rows[r] >> (64 - shift);
+                if (spill != 0) {
+                    op(row[1], spill);
+                }
+            }
+        }
+    }
+
+    size_t width_{};
+    size_t height_{};
+    size_t words_per_row_{};
+    size_t filled_{};
+    std::vector<uint64_t> bits_{};
+};
+
+namespace std {
+    template<>
+    struct hash<BitRegion>
+    {
+        size_t operator()(const BitRegion& region) const noexcept
+        {
+            const auto& words = region.words();
+            uint64_t seed = tools::mum(region.width() ^ 0x9e3779b97f4a7c15ull, region.height() ^ 0x3c6ef372fe94f82aull);
+            return static_cast<size_t>(tools::hash_bytes(reinterpret_cast<const char*>(words.data()),
+                words.size() * sizeof(uint64_t), seed));
+        }
+    };
+}
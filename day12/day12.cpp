@@ -9,115 +9,47 @@
 #include <set>
 #include "matrix.h"
 #include "load_data.h"
+#include "solver.h"
+#include "parallel.h"
 #include <unordered_map>
 #include <chrono>
 
 
 
-std::optional<tools::CharMatrix> try_place_shape_in_region(tools::CharMatrix region, const tools::CharMatrix& shape, size_t top, size_t left,char ch)
+int main(int argc, char* argv[])
 {
-	if (top + shape.num_rows() > region.num_rows() || left + shape.num_cols() > region.num_cols())
+	// --solver=dfs|dlx: backend for regions the pre-filter cannot decide
+	// --first-empty-cell: branch on the first uncovered cell
+	// --no-canonical: also try identical pieces in every order
+	// --no-prefilter: send every region to the solver (for benchmarking)
+	SearchOptions options;
+	bool use_prefilter = true;
+	for (int a = 1; a < argc; ++a)
 	{
-		return std::nullopt; // Shape does not fit in the region at the specified position
-	}
-	for (size_t r = 0; r < shape.num_rows(); ++r)
-	{
-		auto region_row = region.get_row(top + r);
-		auto shape_row = shape.get_row(r);
-		for (size_t c = 0; c < shape.num_cols(); ++c)
-		{
-			if (shape_row[c] != '.' && region_row[left + c] != '.')
-			{
-				return std::nullopt; // Overlap detected
-			}
-			else if (shape_row[c] != '.')
-			{
-				region_row[left + c] = ch; // Place shape character
-			}
-		}
-	}
-	//std::cout << "new_region: \n";
-	//tools::print_charmatrix(region);
-	return region; // Shape can be placed without overlap
-}
-
-using cache_t = std::unordered_map<tools::CharMatrix, size_t >; 
-
-bool try_to_fit_shapes_in_region(const std::vector<Shape>& shapes, tools::CharMatrix region_matrix, size_t shape_idx, cache_t& cache)
-{
-	auto iter = cache.find(region_matrix);
-	if (iter != cache.end())
-	{
-		if (iter->second >= shape_idx)
-			return false;
-	}
-	size_t remaining_filled=0;
-	for(size_t i=shape_idx;i<shapes.size();++i)
-	{
-		remaining_filled += shapes[i].shape.count_elements();
-	}
-	size_t free_in_region = region_matrix.num_cols()*region_matrix.num_rows() - region_matrix.count_elements();
-	if (free_in_region < remaining_filled)
-	{
-		if (iter != cache.end())
-		{
-			if (iter->second < shape_idx)
-			{
-				iter->second = shape_idx;
-			}
-		}
+		const std::string arg = argv[a];
+		if (arg == "--solver=dfs")
+			options.backend = SolverBackend::dfs;
+		else if (arg == "--solver=dlx")
+			options.backend = SolverBackend::dlx;
+		else if (arg == "--no-prefilter")
+			use_prefilter = false;
+		else if (arg == "--first-empty-cell")
+			options.first_empty_cell = true;
+		else if (arg == "--no-canonical")
+			options.canonical_copies = false;
 		else
 		{
-			cache[region_matrix] = shape_idx;
-		}
-		return false;
-	}
-	for (size_t xt = 0; xt < region_matrix.num_cols(); ++xt)
-	{
-		for (size_t yt = 0; yt < region_matrix.num_rows(); ++yt)
-		{
-			for (const tools::CharMatrix& current_dev_shape : shapes[shape_idx].derived_shapes)
-			{
-				auto attempt = try_place_shape_in_region(region_matrix, current_dev_shape, yt, xt,'#');
-				if (attempt)
-				{
-					auto next_shape_idx = shape_idx + 1;
-					if (next_shape_idx == shapes.size())
-					{
-						//std::cout << "All shapes placed successfully.\n";
-						return true;
-					}
-					/*std::cout << "new_region: \n";
-					tools::print_charmatrix(*attempt);*/
-					auto suc = try_to_fit_shapes_in_region(shapes, *attempt, next_shape_idx,cache);
-					if (suc)
-					{
-						return true;
-					}
-				}
-			}
-		}
-	}
-	if (iter != cache.end())
-	{
-		if (iter->second < shape_idx)
-		{
-			iter->second = shape_idx;
+			std::cerr << "Unknown option: " << arg << "\n";
+			return 1;
 		}
 	}
-	else
-	{
-		cache[region_matrix] = shape_idx;
-	}
-	return false;
-}
-
-
-
-
-int main()
-{
 	size_t can_fit_count = 0;
+	struct
+	{
+		size_t too_small = 0;
+		size_t trivially_fits = 0;
+		size_t searched = 0;
+	} tier_hits;
 	std::vector<Shape> shapes;
 	std::vector<Region> regions;
 	try {
@@ -130,26 +62,20 @@ int main()
 	{
 		shape.build_derived_shapes();
 	}
+	// pieces of every region, identical shapes next to each other
+	std::vector<std::vector<const Shape*>> region_pieces(regions.size());
 	for (size_t i=0;i<regions.size();++i)
 	{
-		auto loop_start = std::chrono::steady_clock::now();
-		const auto& region = regions[i];
-		tools::CharMatrix region_matrix(region.height, region.width, '.');
-		std::vector<Shape> shapes_to_fit;
 		size_t id = 0;
-		for (int shape_count : region.shapes_to_integrate)
+		for (int shape_count : regions[i].shapes_to_integrate)
 		{
 			auto it = std::find_if(shapes.begin(), shapes.end(), [&id](const Shape& s) { return s.id == id; });
 			if (it != shapes.end())
 			{
 				for (int j = 0; j < shape_count;j++)
 				{
-					shapes_to_fit.push_back(*it);
+					region_pieces[i].push_back(&*it);
 				}
-				/*if (shape_count > 0)
-				{
-					tools::print_charmatrix(it->shape);
-				}*/
 			}
 			else
 			{
@@ -158,24 +84,90 @@ int main()
 			}
 			++id;
 		}
-		
-		cache_t cache;
+	}
+
+	struct RegionResult
+	{
+		RegionClass region_class{};
+		bool can_fit = false;
+		long long duration_ms = 0;
+	};
+	std::vector<RegionResult> results(regions.size());
+
+	// regions are handed out to the workers one at a time; every worker keeps
+	// its own transposition table and only clears it between regions
+	const size_t workers = std::min(tools::worker_count(), std::max<size_t>(1, regions.size()));
+	std::vector<cache_t> caches(workers);
+	for (auto& cache : caches)
+	{
 		cache.rehash(std::numeric_limits<int16_t>::max());
-		auto can_fit = try_to_fit_shapes_in_region(shapes_to_fit, region_matrix, 0,cache);
-		if (can_fit)
+	}
+
+	auto total_start = std::chrono::steady_clock::now();
+	try {
+		tools::parallel_for_dynamic(workers, regions.size(), [&](size_t worker, size_t i)
+		{
+			auto loop_start = std::chrono::steady_clock::now();
+			const auto& region = regions[i];
+			const auto& shapes_to_fit = region_pieces[i];
+			RegionResult& result = results[i];
+			result.region_class = use_prefilter ? classify_region(shapes_to_fit, region.width, region.height) : RegionClass::needs_search;
+			switch (result.region_class)
+			{
+			case RegionClass::too_small:
+				break;
+			case RegionClass::trivially_fits:
+				result.can_fit = true;
+				break;
+			case RegionClass::needs_search:
+			{
+				cache_t& cache = caches[worker];
+				cache.clear();
+				result.can_fit = fit_shapes_in_region(shapes_to_fit, region.width, region.height, options, cache);
+				break;
+			}
+			}
+			auto loop_end = std::chrono::steady_clock::now();
+			result.duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(loop_end - loop_start).count();
+		});
+	} catch (const std::exception& ex) {
+		std::cerr << "Error solving regions: " << ex.what() << "\n";
+		return 1;
+	}
+
+	// report in input order
+	for (size_t i=0;i<regions.size();++i)
+	{
+		const auto& region = regions[i];
+		const auto& result = results[i];
+		switch (result.region_class)
+		{
+		case RegionClass::too_small:
+			++tier_hits.too_small;
+			break;
+		case RegionClass::trivially_fits:
+			++tier_hits.trivially_fits;
+			break;
+		case RegionClass::needs_search:
+			++tier_hits.searched;
+			break;
+		}
+		if (result.can_fit)
 		{
 			++can_fit_count;
 			std::cout << "Shapes can fit in the region of size " << region.width << "x" << region.height << "\n";
-			//tools::print_charmatrix(*can_fit);
 		}
 		else
 		{
 			std::cout << "Shapes cannot fit in the region of size " << region.width << "x" << region.height << "\n";
 		}
-		auto loop_end = std::chrono::steady_clock::now();
-		const auto loop_duration = std::chrono::duration_cast<std::chrono::milliseconds>(loop_end - loop_start).count();
-		std::cout << "Region " << i << " processing time: " << loop_duration << " ms\n";
+		std::cout << "Region " << i << " processing time: " << result.duration_ms << " ms\n";
 	}
+	const auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - total_start).count();
+	std::cout << "Total processing time: " << total_duration << " ms\n";
+	std::cout << "Pre-filter: " << tier_hits.too_small << " regions rejected by area, "
+		<< tier_hits.trivially_fits << " accepted by bounding-box tiling, "
+		<< tier_hits.searched << " sent to the exact solver\n";
 	std::cout << "Total number of regions where shapes can fit: " << can_fit_count << "\n";
 	return 0;
 }
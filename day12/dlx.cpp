@@ -0,0 +1,226 @@
+#include "dlx.h"
+
+#include <cstdint>
+#include <span>
+
+namespace {
+
+class DancingLinks {
+public:
+    // primary columns 0..needs.size()-1 with their required counts, secondary
+    // columns after them
+    DancingLinks(std::vector<uint32_t> needs, size_t secondary)
+        : need(std::move(needs)), root(static_cast<uint32_t>(need.size() + secondary))
+    {
+        const size_t columns = need.size() + secondary;
+        nodes.resize(columns);
+        size.assign(columns, 0);
+        left.resize(columns + 1);
+        right.resize(columns + 1);
+        for (uint32_t c = 0; c < columns; ++c) {
+            nodes[c] = Node{ c, c, c };
+            // secondary columns are not part of the header list
+            left[c] = right[c] = c;
+        }
+        left[root] = right[root] = root;
+        for (uint32_t c = 0; c < need.size(); ++c) {
+            if (need[c] == 0) {
+                continue;
+            }
+            left[c] = left[root];
+            right[c] = root;
+            right[left[root]] = c;
+            left[root] = c;
+        }
+        row_first.push_back(static_cast<uint32_t>(nodes.size()));
+    }
+
+    // the first column of a row must be its primary (type) column
+    void add_row(std::span<const uint32_t> columns)
+    {
+        for (uint32_t c : columns) {
+            const auto n = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(Node{ nodes[c].up, c, c });
+            nodes[nodes[c].up].down = n;
+            nodes[c].up = n;
+            ++size[c];
+        }
+        row_first.push_back(static_cast<uint32_t>(nodes.size()));
+        row_of.resize(nodes.size(), static_cast<uint32_t>(row_first.size() - 2));
+    }
+
+    // cells_left: filled cells of all pieces still to place, free_cells: uncovered cells
+    bool search(size_t cells_left, size_t free_cells)
+    {
+        if (right[root] == root) {
+            return true;
+        }
+        if (free_cells < cells_left) {
+            return false;
+        }
+
+        // column-size heuristic: the type with the fewest remaining placements
+        uint32_t best = right[root];
+        for (uint32_t c = right[best]; c != root; c = right[c]) {
+            if (size[c] < size[best]) {
+                best = c;
+            }
+        }
+        if (size[best] < need[best]) {
+            return false;
+        }
+
+        // rows tried at this level are hidden for their later siblings, so
+        // identical copies are never placed in two different orders
+        std::vector<uint32_t> hidden;
+        bool found = false;
+        for (uint32_t r = nodes[best].down; r != best && !found; ) {
+            const uint32_t next = nodes[r].down;
+            const uint32_t row = row_of[r];
+            const size_t cells = row_first[row + 1] - row_first[row] - 1;
+
+            const bool last_copy = --need[best] == 0;
+            if (last_copy) {
+                cover(best);
+            }
+            for (uint32_t j = row_first[row] + 1; j < row_first[row + 1]; ++j) {
+                cover(nodes[j].column);
+            }
+            found = search(cells_left - cells, free_cells - cells);
+            for (uint32_t j = row_first[row + 1]; j-- > row_first[row] + 1; ) {
+                uncover(nodes[j].column);
+            }
+            if (last_copy) {
+                uncover(best);
+            }
+            ++need[best];
+
+            hide_row(row);
+            hidden.push_back(row);
+            r = next;
+        }
+        for (auto it = hidden.rbegin(); it != hidden.rend(); ++it) {
+            unhide_row(*it);
+        }
+        return found;
+    }
+
+private:
+    struct Node {
+        uint32_t up;
+        uint32_t down;
+        uint32_t column;
+    };
+
+    void unlink_vertical(uint32_t n)
+    {
+        nodes[nodes[n].up].down = nodes[n].down;
+        nodes[nodes[n].down].up = nodes[n].up;
+        --size[nodes[n].column];
+    }
+
+    void relink_vertical(uint32_t n)
+    {
+        nodes[nodes[n].up].down = n;
+        nodes[nodes[n].down].up = n;
+        ++size[nodes[n].column];
+    }
+
+    void cover(uint32_t c)
+    {
+        right[left[c]] = right[c];
+        left[right[c]] = left[c];
+        for (uint32_t i = nodes[c].down; i != c; i = nodes[i].down) {
+            const uint32_t row = row_of[i];
+            for (uint32_t j = row_first[row]; j < row_first[row + 1]; ++j) {
+                if (j != i) {
+                    unlink_vertical(j);
+                }
+            }
+        }
+    }
+
+    void uncover(uint32_t c)
+    {
+        for (uint32_t i = nodes[c].up; i != c; i = nodes[i].up) {
+            const uint32_t row = row_of[i];
+            for (uint32_t j = row_first[row + 1]; j-- > row_first[row]; ) {
+                if (j != i) {
+                    relink_vertical(j);
+                }
+            }
+        }
+        right[left[c]] = c;
+        left[right[c]] = c;
+    }
+
+    void hide_row(uint32_t row)
+    {
+        for (uint32_t j = row_first[row]; j < row_first[row + 1]; ++j) {
+            unlink_vertical(j);
+        }
+    }
+
+    void unhide_row(uint32_t row)
+    {
+        for (uint32_t j = row_first[row + 1]; j-- > row_first[row]; ) {
+            relink_vertical(j);
+        }
+    }
+
+    std::vector<uint32_t> need;
+    uint32_t root;
+    // column headers first, then the row nodes
+    std::vector<Node> nodes;
+    std::vector<uint32_t> size;
+    // header list over the primary columns, root at index `root`
+    std::vector<uint32_t> left;
+    std::vector<uint32_t> right;
+    // nodes of row r are [row_first[r], row_first[r + 1])
+    std::vector<uint32_t> row_first;
+    std::vector<uint32_t> row_of;
+};
+
+} // namespace
+
+bool fit_shapes_dlx(const std::vector<const Shape*>& pieces, size_t width, size_t height)
+{
+    // one primary column per distinct shape, identical shapes are adjacent
+    std::vector<const Shape*> types;
+    std::vector<uint32_t> needs;
+    size_t cells_left = 0;
+    for (const Shape* piece : pieces) {
+        if (types.empty() || types.back() != piece) {
+            types.push_back(piece);
+            needs.push_back(0);
+        }
+        ++needs.back();
+        cells_left += piece->masks.front().cells;
+    }
+    if (cells_left > width * height) {
+        return false;
+    }
+
+    const auto type_count = static_cast<uint32_t>(types.size());
+    DancingLinks links(std::move(needs), width * height);
+    std::vector<uint32_t> columns;
+    for (uint32_t t = 0; t < type_count; ++t) {
+        for (const ShapeMask& mask : types[t]->masks) {
+            if (mask.width > width || mask.height > height) {
+                continue;
+            }
+            for (size_t top = 0; top + mask.height <= height; ++top) {
+                for (size_t left = 0; left + mask.width <= width; ++left) {
+                    columns.clear();
+                    columns.push_back(t);
+                    for (size_t k = 0; k < mask.cells; ++k) {
+                        const CellOffset cell = mask.offsets[k];
+                        columns.push_back(static_cast<uint32_t>(type_count + (top + cell.row) * width + left + cell.col));
+                    }
+                    links.add_row(columns);
+                }
+            }
+        }
+    }
+    return links.search(cells_left, width * height);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <vector>
+#include "load_data.h"
+
+// Dancing Links (Algorithm X) backend for the packing problem. Primary
+// columns are the shape types, each with the number of copies still to
+// place; secondary columns are the region cells, which may be covered at
+// most once or stay empty. A row is one placement (type, orientation,
+// position) and covers its type column plus the cells under the shape.
+bool fit_shapes_dlx(const std::vector<const Shape*>& pieces, size_t width, size_t height);
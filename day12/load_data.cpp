@@ -1,13 +1,10 @@
 #include "load_data.h"
 
 #include <algorithm>
-#include <array>
 #include <cctype>
 #include <fstream>
-#include <set>
 #include <sstream>
 #include <stdexcept>
-#include <string_view>
 
 namespace {
 std::string trim(const std::string& value) {
@@ -78,89 +75,6 @@ void append_shape(std::vector<Shape>& shapes, int id, const std::vector<std::str
 
     shapes.push_back(Shape{ id, tools::CharMatrix(rows.size(), width, std::move(buffer)) });
 }
-
-std::string matrix_signature(const tools::CharMatrix& matrix) {
-    std::string signature;
-    signature.reserve(matrix.num_rows() * (matrix.num_cols() + 1) + 32);
-    signature.append(std::to_string(matrix.num_rows()));
-    signature.push_back('x');
-    signature.append(std::to_string(matrix.num_cols()));
-    signature.push_back(':');
-
-    for (size_t r = 0; r < matrix.num_rows(); ++r) {
-        const auto row = matrix.get_row(r);
-        signature.append(row.begin(), row.end());
-        signature.push_back('|');
-    }
-
-    return signature;
-}
-
-tools::CharMatrix rotate_clockwise(const tools::CharMatrix& matrix) {
-    const size_t rows = matrix.num_rows();
-    const size_t cols = matrix.num_cols();
-    std::vector<char> buffer(rows * cols);
-
-    for (size_t r = 0; r < cols; ++r) {
-        for (size_t c = 0; c < rows; ++c) {
-            const size_t src_row = rows - 1 - c;
-            const size_t src_col = r;
-            buffer[r * rows + c] = matrix.get_row(src_row)[src_col];
-        }
-    }
-
-    return tools::CharMatrix(cols, rows, std::move(buffer));
-}
-
-tools::CharMatrix flip_horizontal(const tools::CharMatrix& matrix) {
-    const size_t rows = matrix.num_rows();
-    const size_t cols = matrix.num_cols();
-    std::vector<char> buffer(rows * cols);
-
-    for (size_t r = 0; r < rows; ++r) {
-        const auto source_row = matrix.get_row(r);
-        for (size_t c = 0; c < cols; ++c) {
-            buffer[r * cols + c] = source_row[cols - 1 - c];
-        }
-    }
-
-    return tools::CharMatrix(rows, cols, std::move(buffer));
-}
-
-tools::CharMatrix flip_vertical(const tools::CharMatrix& matrix) {
-    const size_t rows = matrix.num_rows();
-    const size_t cols = matrix.num_cols();
-    std::vector<char> buffer(rows * cols);
-
-    for (size_t r = 0; r < rows; ++r) {
-        const auto source_row = matrix.get_row(rows - 1 - r);
-        for (size_t c = 0; c < cols; ++c) {
-            buffer[r * cols + c] = source_row[c];
-        }
-    }
-
-    return tools::CharMatrix(rows, cols, std::move(buffer));
-}
-
-tools::CharMatrix apply_operations(const tools::CharMatrix& base, std::string_view operations) {
-    tools::CharMatrix transformed = base;
-    for (char op : operations) {
-        switch (op) {
-        case 'R':
-            transformed = rotate_clockwise(transformed);
-            break;
-        case 'H':
-            transformed = flip_horizontal(transformed);
-            break;
-        case 'V':
-            transformed = flip_vertical(transformed);
-            break;
-        default:
-            break;
-        }
-    }
-    return transformed;
-}
 } // namespace
 
 void load_input_file(const std::string& filepath, std::vector<Shape>& shapes, std::vector<Region>& regions) {
@@ -260,30 +174,5 @@ void load_input_file(const std::string& filepath, std::vector<Shape>& shapes, st
 }
 
 void Shape::build_derived_shapes() {
-    derived_shapes.clear();
-
-    std::set<std::string> seen;
-    auto add_variant = [&](tools::CharMatrix candidate) {
-        if (seen.insert(matrix_signature(candidate)).second) {
-            derived_shapes.push_back(std::move(candidate));
-        }
-    };
-
-    add_variant(shape);
-
-    constexpr std::array<std::string_view, 4> rotations{ "", "R", "RR", "RRR" };
-    constexpr std::array<std::string_view, 4> flips{ "", "H", "V", "HV" };
-
-    for (const auto flip_ops : flips) {
-        for (const auto rot_ops : rotations) {
-            std::string sequence;
-            sequence.reserve(flip_ops.size() + rot_ops.size());
-            sequence.append(flip_ops);
-            sequence.append(rot_ops);
-            if (sequence.empty()) {
-                continue;
-            }
-            add_variant(apply_operations(shape, sequence));
-        }
-    }
+    masks = ShapeOrientations(shape);
 }
@@ -3,11 +3,13 @@
 #include <string>
 #include <vector>
 #include "matrix.h"
+#include "bitboard.h"
 
 struct Shape {
     int id{};
     tools::CharMatrix shape{};
-    std::vector<tools::CharMatrix> derived_shapes{};
+    // distinct rotations and reflections as row bitmasks for the placement engine
+    ShapeOrientations masks{};
     void build_derived_shapes();
 };
 
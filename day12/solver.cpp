@@ -0,0 +1,198 @@
+#include "solver.h"
+
+#include <algorithm>
+#include "dlx.h"
+
+namespace {
+
+struct DfsContext {
+    const std::vector<const Shape*>& pieces;
+    // remaining_cells[i]: filled cells of pieces i..end
+    std::vector<size_t> remaining_cells;
+    BitRegion& region;
+    cache_t& cache;
+    bool canonical_copies;
+};
+
+// remember that the pieces from shape_idx on do not fit into this occupancy
+void remember_failure(cache_t& cache, const BitRegion& region, size_t shape_idx)
+{
+    auto [iter, inserted] = cache.try_emplace(region, shape_idx);
+    if (!inserted && iter->second < shape_idx) {
+        iter->second = shape_idx;
+    }
+}
+
+// Places pieces[shape_idx]. Candidates are enumerated by key
+// ((x * height + y) * orientations + orientation); a copy of the previous
+// piece only tries keys from min_key on.
+bool try_to_fit_shapes_in_region(DfsContext& ctx, size_t shape_idx, size_t min_key)
+{
+    const auto& pieces = ctx.pieces;
+    BitRegion& region = ctx.region;
+    const bool same_as_previous = ctx.canonical_copies && shape_idx > 0 && pieces[shape_idx] == pieces[shape_idx - 1];
+
+    // inside a run of identical copies the occupancy alone does not describe the
+    // state (min_key matters too), so the table is only used at run boundaries
+    if (!same_as_previous) {
+        auto iter = ctx.cache.find(region);
+        if (iter != ctx.cache.end() && iter->second >= shape_idx) {
+            return false;
+        }
+    }
+    if (region.area() - region.filled() < ctx.remaining_cells[shape_idx]) {
+        if (!same_as_previous) {
+            remember_failure(ctx.cache, region, shape_idx);
+        }
+        return false;
+    }
+
+    const auto& masks = pieces[shape_idx]->masks;
+    const size_t orientations = masks.size();
+    const size_t height = region.height();
+    const size_t start_key = same_as_previous ? min_key : 0;
+    size_t first_orientation = start_key % orientations;
+    size_t yt = (start_key / orientations) % height;
+    for (size_t xt = start_key / orientations / height; xt < region.width(); ++xt, yt = 0) {
+        for (; yt < height; ++yt, first_orientation = 0) {
+            for (size_t o = first_orientation; o < orientations; ++o) {
+                const ShapeMask& current_mask = masks[o];
+                if (!region.can_place(current_mask, yt, xt)) {
+                    continue;
+                }
+                const size_t next_shape_idx = shape_idx + 1;
+                if (next_shape_idx == pieces.size()) {
+                    return true;
+                }
+                region.place(current_mask, yt, xt);
+                const size_t next_key = (xt * height + yt) * orientations + o + 1;
+                const bool suc = try_to_fit_shapes_in_region(ctx, next_shape_idx, next_key);
+                region.remove(current_mask, yt, xt);
+                if (suc) {
+                    return true;
+                }
+            }
+        }
+    }
+    if (!same_as_previous) {
+        remember_failure(ctx.cache, region, shape_idx);
+    }
+    return false;
+}
+
+struct PieceGroup {
+    const Shape* shape;
+    size_t count;
+};
+
+struct CellContext {
+    std::vector<PieceGroup> groups;
+    BitRegion& region;
+};
+
+// All cells before `cursor` are decided. The first undecided cell is either
+// covered by a piece whose first filled cell lands on it, or left empty.
+// Identical pieces are only counted, so their order never matters.
+bool cover_first_empty_cell(CellContext& ctx, size_t cursor, size_t pieces_left, size_t cells_left)
+{
+    if (pieces_left == 0) {
+        return true;
+    }
+    BitRegion& region = ctx.region;
+    if (region.area() - region.filled() < cells_left) {
+        return false;
+    }
+    const size_t cell = region.first_empty(cursor);
+    if (cell == region.area()) {
+        return false;
+    }
+    const size_t r = cell / region.width();
+    const size_t c = cell % region.width();
+
+    for (auto& group : ctx.groups) {
+        if (group.count == 0) {
+            continue;
+        }
+        for (const ShapeMask& mask : group.shape->masks) {
+            if (mask.first_row > r || mask.first_col > c) {
+                continue;
+            }
+            const size_t top = r - mask.first_row;
+            const size_t left = c - mask.first_col;
+            if (!region.can_place(mask, top, left)) {
+                continue;
+            }
+            region.place(mask, top, left);
+            --group.count;
+            const bool suc = cover_first_empty_cell(ctx, cell + 1, pieces_left - 1, cells_left - mask.cells);
+            ++group.count;
+            region.remove(mask, top, left);
+            if (suc) {
+                return true;
+            }
+        }
+    }
+
+    region.set_cell(r, c);
+    const bool suc = cover_first_empty_cell(ctx, cell + 1, pieces_left, cells_left);
+    region.clear_cell(r, c);
+    return suc;
+}
+
+} // namespace
+
+RegionClass classify_region(const std::vector<const Shape*>& pieces, size_t width, size_t height)
+{
+    size_t cells = 0;
+    size_t box_width = 0;
+    size_t box_height = 0;
+    for (const Shape* piece : pieces) {
+        cells += piece->masks.front().cells;
+        box_width = std::max(box_width, piece->shape.num_cols());
+        box_height = std::max(box_height, piece->shape.num_rows());
+    }
+    if (cells > width * height) {
+        return RegionClass::too_small;
+    }
+    if (pieces.empty()) {
+        return RegionClass::trivially_fits;
+    }
+    // boxes in their original orientation or all rotated by 90 degrees
+    const size_t boxes = (width / box_width) * (height / box_height);
+    const size_t rotated_boxes = (width / box_height) * (height / box_width);
+    if (std::max(boxes, rotated_boxes) >= pieces.size()) {
+        return RegionClass::trivially_fits;
+    }
+    return RegionClass::needs_search;
+}
+
+bool fit_shapes_in_region(const std::vector<const Shape*>& pieces, size_t width, size_t height,
+    const SearchOptions& options, cache_t& cache)
+{
+    if (pieces.empty()) {
+        return true;
+    }
+    if (options.backend == SolverBackend::dlx) {
+        return fit_shapes_dlx(pieces, width, height);
+    }
+    BitRegion region(width, height);
+
+    if (options.first_empty_cell) {
+        CellContext ctx{ {}, region };
+        size_t cells = 0;
+        for (const Shape* piece : pieces) {
+            if (ctx.groups.empty() || ctx.groups.back().shape != piece) {
+                ctx.groups.push_back(PieceGroup{ piece, 0 });
+            }
+            ++ctx.groups.back().count;
+            cells += piece->masks.front().cells;
+        }
+        return cover_first_empty_cell(ctx, 0, pieces.size(), cells);
+    }
+
+    DfsContext ctx{ pieces, std::vector<size_t>(pieces.size() + 1, 0), region, cache, options.canonical_copies };
+    for (size_t k = pieces.size(); k-- > 0;) {
+        ctx.remaining_cells[k] = ctx.remaining_cells[k + 1] + pieces[k]->masks.front().cells;
+    }
+    return try_to_fit_shapes_in_region(ctx, 0, 0);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "bitboard.h"
+#include "load_data.h"
+
+// transposition table: occupancy -> largest piece index s for which
+// pieces[s..] is known not to fit from there. Failing with more pieces left
+// (a smaller s) does not imply failing with fewer, so lookups prune when the
+// stored value is >= the current index and updates keep the maximum.
+using cache_t = std::unordered_map<BitRegion, size_t>;
+
+enum class SolverBackend {
+    // depth-first placement search on bitboards with a transposition table
+    dfs,
+    // Dancing Links exact cover, see dlx.h
+    dlx,
+};
+
+struct SearchOptions {
+    SolverBackend backend = SolverBackend::dfs;
+    // each copy of a repeated shape must be placed after the previous copy
+    // (position, then orientation), so identical pieces are never permuted
+    bool canonical_copies = true;
+    // branch on the first uncovered cell (cover it with any remaining piece or
+    // leave it empty) instead of trying every position for the next piece
+    bool first_empty_cell = false;
+};
+
+// Cheap pre-filter tiers that decide a region without search.
+enum class RegionClass {
+    // total piece area exceeds the region area
+    too_small,
+    // every piece gets its own bounding box in a plain grid of boxes
+    trivially_fits,
+    // neither tier applies, the exact solver has to decide
+    needs_search,
+};
+
+RegionClass classify_region(const std::vector<const Shape*>& pieces, size_t width, size_t height);
+
+// pieces: the shapes to place, identical shapes next to each other
+bool fit_shapes_in_region(const std::vector<const Shape*>& pieces, size_t width, size_t height,
+    const SearchOptions& options, cache_t& cache);
@@ -5,8 +5,9 @@
 #include <ranges>
 #include <numeric>
 #include <charconv>
-#include <cmath>
+#include <array>
 #include "long-int.h"
+#include "parallel.h"
 
 struct bank
 {
@@ -39,27 +40,61 @@ std::vector<bank> load_input(const std::string& filename)
 	return banks;
 }
 
-int get_max_jolt(const bank& bank)
+// Ergebnis beider Teile fr eine Bank bzw. die Summe ber mehrere Banks
+struct jolt_totals
 {
-	auto it_first = std::max_element(bank.battery.begin(), bank.battery.end() - 1);
-	auto it_second = std::max_element(it_first + 1, bank.battery.end());
-	return (*it_first) * 10 + (*it_second);
-}
+	int64_t part1{};
+	LongInt256 part2{};
+
+	friend jolt_totals operator+(jolt_totals a, const jolt_totals& b)
+	{
+		a.part1 += b.part1;
+		a.part2 += b.part2;
+		return a;
+	}
+};
+
+// Greedy-Auswahl der grten Teilfolge mit K Ziffern, Ziffer fr Ziffer:
+// eine kleinere Ziffer wird verdrngt, solange danach noch genug Ziffern brig sind
+template<size_t K>
+struct digit_selector
+{
+	std::array<int, K> digits{};
+	size_t count = 0;
 
-LongInt256 get_max_jolt(const bank& bank, int numdigits)
+	void push(int digit, size_t remaining_after)
+	{
+		while (count > 0 && digits[count - 1] < digit && count + remaining_after >= K)
+		{
+			--count;
+		}
+		if (count < K)
+		{
+			digits[count++] = digit;
+		}
+	}
+};
+
+// beide Teile in einem Durchlauf ber die Bank berechnen
+jolt_totals evaluate_bank(const bank& bank)
 {
-	LongInt256 result=0;
-	auto it_current = bank.battery.begin();
-	int64_t factor = static_cast<int64_t>(std::pow(10, numdigits - 1));
-	while (factor > 0)
+	digit_selector<2> two;
+	digit_selector<12> twelve;
+	const size_t n = bank.battery.size();
+	for (size_t i = 0; i < n; ++i)
 	{
-		it_current = std::max_element(it_current, bank.battery.end() - numdigits + 1);
-		result += *it_current * factor;
-		it_current++;
-		factor /= 10;
-		numdigits--;
+		const int digit = bank.battery[i];
+		two.push(digit, n - i - 1);
+		twelve.push(digit, n - i - 1);
 	}
-	return result;
+	jolt_totals totals{};
+	totals.part1 = two.digits[0] * 10 + two.digits[1];
+	for (int digit : twelve.digits)
+	{
+		totals.part2 *= 10;
+		totals.part2 += digit;
+	}
+	return totals;
 }
 
 int main()
@@ -67,23 +102,16 @@ int main()
 	//auto banks = load_input("C:/source_code/advent_of_code_2025/day3/input/example.txt");
 	auto banks = load_input("C:/source_code/advent_of_code_2025/day3/input/input.txt");
 
-	// ranges-basierte Transformation: erzeugt eine View, die fr jedes `bank` get_max_jolt aufruft
-	auto jolt_view = banks | std::views::transform([](const bank& b) { return get_max_jolt(b); });
+	// Banks werden auf die verfgbaren Threads verteilt, die Teilsummen mit LongInt256 reduziert
+	jolt_totals totals = tools::parallel_transform_reduce(banks.size(), jolt_totals{}, std::plus<>{},
+		[&banks](size_t i) { return evaluate_bank(banks[i]); });
 
 	//// Werte ausgeben (optional)
-	//for (int j : jolt_view)
-	//	std::cout << j << '\n';
-
-	// Summe der Werte berechnen und ausgeben
-	int total = std::accumulate(std::ranges::begin(jolt_view), std::ranges::end(jolt_view), 0);
-	std::cout << "Total Part 1: " << total << '\n';
+	//for (const auto& b : banks)
+	//	std::cout << evaluate_bank(b).part2 << '\n';
 
-	auto jolt_view_part2 = banks | std::views::transform([](const bank& b) { return get_max_jolt(b, 12); });
-	for (const auto& val : jolt_view_part2)
-		std::cout << val << '\n';
-	LongInt256 total_part2 = std::accumulate(std::ranges::begin(jolt_view_part2), std::ranges::end(jolt_view_part2), LongInt256(0),
-		[](const LongInt256& a, const LongInt256& b){ LongInt256 r = a; r += b; return r; });
-	std::cout << "Total Part 2: " << total_part2 << '\n';
+	std::cout << "Total Part 1: " << totals.part1 << '\n';
+	std::cout << "Total Part 2: " << totals.part2 << '\n';
 
 	return 0;
 }
\ No newline at end of file
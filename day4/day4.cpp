@@ -7,27 +7,13 @@
 // laut aufgabe sind valide Rollen Eintrge bei denen ein @ steht und weniger als 4 der acht nachbarn ein @ enthalten
 bool is_valid_role(tools::CharMatrix& matrix, int row, int col,bool remove=false)
 {
-	if (matrix[row][col] != '@')
+	if (matrix.at_unchecked(row, col) != '@')
+		return false;
+	// Nachbarfenster wird einmal auf die Matrix beschnitten, danach ohne Bereichsprfung gezhlt
+	if (matrix.count_neighbours(row, col, '@') >= 4)
 		return false;
-	int neighbor_count = 0;
-	for (int dr = -1; dr <= 1; ++dr)
-	{
-		for (int dc = -1; dc <= 1; ++dc)
-		{
-			int test_row = row + dr;
-			int test_col = col + dc;
-			if ((dr == 0 && dc == 0) || test_col < 0 || test_row < 0 || test_col >= matrix.num_cols() || test_row >= matrix.num_rows())
-				continue; // skip self and out-of-bounds
-			if (matrix[test_row][test_col] == '@')
-			{
-				neighbor_count++;
-				if (neighbor_count >= 4)
-					return false;
-			}
-		}
-	}
 	if(remove)
-		matrix[row][col] = '.';
+		matrix.at_unchecked(row, col) = '.';
 	return true;
 }
 
@@ -7,132 +7,222 @@
 #include "range.h"
 #include "long-int.h"
 #include "matrix.h"
+#include "mapped-file.h"
 #include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <span>
+#include <string_view>
 #include <ranges>
 #include <limits>
 
 
-std::tuple<tools::Matrix<int64_t>, std::vector<char>> parse_input(const std::filesystem::path& filepath)
+// Skips blanks starting at pos. Runs of spaces are skipped 8 bytes at a time:
+// XOR with a word of spaces leaves zero bytes exactly where the input has a
+// space, so the first non-zero byte marks the first non-space character.
+size_t skip_blanks(std::string_view line, size_t pos)
 {
-	std::ifstream input_file(filepath);
-	if (input_file.good() == false)
+	constexpr uint64_t spaces = 0x2020202020202020ull;
+	while (pos + sizeof(uint64_t) <= line.size())
 	{
-		throw std::runtime_error("Could not open file: " + filepath.string());
+		uint64_t word;
+		std::memcpy(&word, line.data() + pos, sizeof(word));
+		const uint64_t diff = word ^ spaces;
+		if (diff != 0)
+		{
+			if constexpr (std::endian::native == std::endian::little)
+				pos += static_cast<size_t>(std::countr_zero(diff)) / 8;
+			else
+				pos += static_cast<size_t>(std::countl_zero(diff)) / 8;
+			break;
+		}
+		pos += sizeof(uint64_t);
 	}
-	// Read matrix of integers until a line is empty or contains only '+' or '*'.
+	while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))
+		++pos;
+	return pos;
+}
 
-	std::vector<int64_t> matrix_data;
-	size_t num_rows = 0;
-	size_t num_cols = 0;
-	std::string line;
-	std::vector<char> operators;
-	while (std::getline(input_file, line))
+size_t count_tokens(std::string_view line)
+{
+	size_t count = 0;
+	size_t pos = skip_blanks(line, 0);
+	while (pos < line.size())
 	{
-		 // trim whitespace
-		auto first = line.find_first_not_of(" \t\r\n");
-		if (first == std::string::npos)
+		++count;
+		while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t' && line[pos] != '\r')
+			++pos;
+		pos = skip_blanks(line, pos);
+	}
+	return count;
+}
+
+// Liest das Arbeitsblatt direkt aus der gemappten Datei. Die Zahlen werden
+// spaltenweise abgelegt, d.h. Zeile i der Matrix enthlt alle Zahlen von Aufgabe i.
+std::tuple<tools::Matrix<int64_t>, std::vector<char>> parse_input(const std::filesystem::path& filepath)
+{
+	tools::MappedFile file(filepath);
+	std::string_view text = file.view();
+
+	// Read lines until a line is empty or contains only '+' or '*'.
+	std::vector<std::string_view> number_lines;
+	std::string_view operator_line;
+	while (!text.empty())
+	{
+		auto eol = text.find('\n');
+		std::string_view line = text.substr(0, eol);
+		text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+
+		auto first = skip_blanks(line, 0);
+		if (first == line.size())
 		{
 			break; // empty line -> stop
 		}
-		auto last = line.find_last_not_of(" \t\r\n");
-		std::string trimmed = line.substr(first, last - first + 1);
-
-		bool operator_line = (trimmed.front() == '+' || trimmed.front() == '*');
+		if (line[first] == '+' || line[first] == '*')
+		{
+			operator_line = line;
+			break;
+		}
+		number_lines.push_back(line);
+	}
 
-		 // parse space-separated integers
-		std::istringstream iss(trimmed);
+	const size_t num_rows = number_lines.size();
+	const size_t num_cols = num_rows > 0 ? count_tokens(number_lines.front()) : count_tokens(operator_line);
+	std::vector<int64_t> column_major(num_rows * num_cols);
 
+	for (size_t row = 0; row < num_rows; ++row)
+	{
+		std::string_view line = number_lines[row];
 		size_t col = 0;
-		if (operator_line)
+		size_t pos = skip_blanks(line, 0);
+		while (pos < line.size())
 		{
-			char val;
-			while (iss >> val)
+			if (col == num_cols)
 			{
-				operators.push_back(val);
-				++col;
+				throw std::runtime_error("Inconsistent number of columns in matrix input");
 			}
-		}
-		else 
-		{
-			int64_t val;
-			while (iss >> val)
+			int64_t val{};
+			auto [ptr, ec] = std::from_chars(line.data() + pos, line.data() + line.size(), val);
+			if (ec != std::errc{})
 			{
-				matrix_data.push_back(val);
-				++col;
+				throw std::runtime_error("Invalid number in matrix input");
 			}
+			column_major[col * num_rows + row] = val;
+			++col;
+			pos = skip_blanks(line, static_cast<size_t>(ptr - line.data()));
 		}
-
-		if (num_cols == 0)
-		{
-			num_cols = col;
-		}
-		else if (col != num_cols)
+		if (col != num_cols)
 		{
 			throw std::runtime_error("Inconsistent number of columns in matrix input");
 		}
-		if(!operator_line)
-			++num_rows;
 	}
 
-	tools::Matrix<int64_t> mat(num_rows, num_cols, std::move(matrix_data));
+	std::vector<char> operators;
+	operators.reserve(num_cols);
+	for (size_t pos = skip_blanks(operator_line, 0); pos < operator_line.size(); pos = skip_blanks(operator_line, pos + 1))
+	{
+		operators.push_back(operator_line[pos]);
+	}
 	if(operators.size() != num_cols)
 	{
 		throw std::runtime_error("Number of operators does not match number of matrix columns");
 	}
-	return { mat, operators };
+
+	return { tools::Matrix<int64_t>(num_cols, num_rows, std::move(column_major)), operators };
 }
 
 
-int64_t parse_input_part2(const std::filesystem::path& filepath)
+// Teil 2: verarbeitet das Arbeitsblatt Spalte fr Spalte (eine Zahl pro
+// Spalte, von oben nach unten gelesen), finish() liefert die Summe.
+class CephalopodReader
 {
-	tools::CharMatrix matrix = tools::read_matrix_from_file(filepath.string());
-	auto operators_row = matrix.pop_last_row();
-	matrix.transpose();
-	char current_operator{};
-	int64_t result = 0;
-	int64_t partial_result = 0;
-	for (size_t i = 0; i < matrix.num_rows(); ++i)
+public:
+	// digits: Ziffernzeilen des Arbeitsblatts, operators: die Operatorzeile
+	// (gleiche Breite)
+	void feed(const tools::CharMatrix& digits, std::span<const char> operators)
 	{
-		if (operators_row[i] == '+' || operators_row[i] == '*')
+		if (operators.size() != digits.num_cols())
 		{
-			current_operator = operators_row[i];	
-			if ((partial_result > 0 && result > (std::numeric_limits<int64_t>::max() - partial_result)) ||
-				(partial_result < 0 && result < (std::numeric_limits<int64_t>::min() - partial_result)))
-			{
-				std::cerr << "Overflow detected while adding result to result (result=" << result
-					<< ", partial_result=" << partial_result  << ")\n";
-				return 1;
-			}
-			result += partial_result;
-			std::cout << "partial result: " << partial_result << ", total result: " << result << "\n";
-			partial_result = current_operator == '+' ? 0 : 1;
+			throw std::runtime_error("Operator row does not match worksheet width");
 		}
-		std::stringstream ss;
-		for (size_t j = 0; j < matrix[i].size();++j)
-			ss << matrix[i][j];
-		auto first = ss.str().find_first_not_of(" \t\r\n");
-		if (first == std::string::npos)
+		for (size_t col = 0; col < digits.num_cols(); ++col)
 		{
-			continue;
-		}
-		auto last = ss.str().find_last_not_of(" \t\r\n");
-		std::string trimmed = ss.str().substr(first, last - first + 1);
-		if (trimmed.empty())
-			continue;
-		int64_t val = tools::string_to_integer<int64_t>(trimmed);
-		if (current_operator == '+')
-		{
-			partial_result += val;
+			if (operators[col] == '+' || operators[col] == '*')
+			{
+				flush();
+				current_operator = operators[col];
+				partial_result = current_operator == '+' ? 0 : 1;
+			}
+
+			int64_t val = 0;
+			bool has_digit = false;
+			for (const char c : digits.column(col))
+			{
+				if (c >= '0' && c <= '9')
+				{
+					const int digit = c - '0';
+					if (val > (std::numeric_limits<int64_t>::max() - digit) / 10)
+					{
+						throw std::overflow_error("Overflow detected while reading a column number");
+					}
+					val = val * 10 + digit;
+					has_digit = true;
+				}
+			}
+			if (!has_digit)
+				continue;
+
+			// val und partial_result sind nie negativ
+			if (current_operator == '+')
+			{
+				if (partial_result > std::numeric_limits<int64_t>::max() - val)
+				{
+					throw std::overflow_error("Overflow detected while adding to partial result");
+				}
+				partial_result += val;
+			}
+			else if (current_operator == '*')
+			{
+				if (val != 0 && partial_result > std::numeric_limits<int64_t>::max() / val)
+				{
+					throw std::overflow_error("Overflow detected while multiplying partial result");
+				}
+				partial_result *= val;
+			}
 		}
-		else if (current_operator == '*')
+	}
+
+	int64_t finish()
+	{
+		flush();
+		return result;
+	}
+
+private:
+	void flush()
+	{
+		if ((partial_result > 0 && result > (std::numeric_limits<int64_t>::max() - partial_result)) ||
+			(partial_result < 0 && result < (std::numeric_limits<int64_t>::min() - partial_result)))
 		{
-			partial_result *= val;
+			throw std::overflow_error("Overflow detected while adding partial result to result");
 		}
+		result += partial_result;
+		partial_result = 0;
 	}
-	result += partial_result;
-	std::cout << "partial result: " << partial_result << ", total result: " << result << "\n";
 
-	return result;
+	char current_operator{};
+	int64_t result = 0;
+	int64_t partial_result = 0;
+};
+
+int64_t parse_input_part2(const std::filesystem::path& filepath)
+{
+	tools::CharMatrix matrix = tools::read_matrix_from_file(filepath.string());
+	auto operators_row = matrix.pop_last_row();
+	CephalopodReader reader;
+	reader.feed(matrix, operators_row);
+	return reader.finish();
 }
 
 
@@ -141,7 +231,6 @@ int main()
 	tools::Matrix<int64_t> mat{};
 	std::vector<char> operators{};
 	std::tie(mat, operators) = parse_input("C:/source_code/advent_of_code_2025/day6/input/input.txt");
-	mat.transpose();
 	int64_t chekl_sum = 0;
 	for (size_t i = 0; i < operators.size(); ++i)
 	{
@@ -159,6 +248,15 @@ int main()
 	}
 	std::cout << "Checksum: " << chekl_sum << "\n";
 
-	auto result = parse_input_part2("C:/source_code/advent_of_code_2025/day6/input/input.txt");
+	int64_t result = 0;
+	try
+	{
+		result = parse_input_part2("C:/source_code/advent_of_code_2025/day6/input/input.txt");
+	}
+	catch (const std::overflow_error& e)
+	{
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
 	std::cout << "Part 2 result: " << result << "\n";
 }
\ No newline at end of file
@@ -20,7 +20,7 @@ struct BeamPos
 	size_t y;
 };
 void sol_part_1(tools::CharMatrix chr_matrix);
-size_t do_step(tools::CharMatrix chr_matrix, BeamPos pos);
+size_t do_step(const tools::CharMatrix& chr_matrix, BeamPos pos);
 
 
 
@@ -43,7 +43,7 @@ auto beampos_cmp = [](const BeamPos& a, const BeamPos& b) {
 };
 std::map<BeamPos, size_t, decltype(beampos_cmp)> cache{ beampos_cmp };
 
-size_t do_step(tools::CharMatrix chr_matrix, BeamPos pos)
+size_t do_step(const tools::CharMatrix& chr_matrix, BeamPos pos)
 {
 	auto iter = cache.find(pos);
 	if (iter != cache.end())
@@ -56,11 +56,11 @@ size_t do_step(tools::CharMatrix chr_matrix, BeamPos pos)
 	{
 		ret_val = 1;
 	}
-	else if (chr_matrix[new_y][pos.x] == '.')
+	else if (chr_matrix.at_unchecked(new_y, pos.x) == '.')
 	{
 		ret_val = do_step(chr_matrix, BeamPos{ pos.x,new_y });
 	}
-	else if (chr_matrix[new_y][pos.x] == '^')
+	else if (chr_matrix.at_unchecked(new_y, pos.x) == '^')
 	{
 		size_t left_ways = do_step(chr_matrix, BeamPos{ pos.x - 1,new_y });
 		size_t right_ways = do_step(chr_matrix, BeamPos{ pos.x + 1,new_y });
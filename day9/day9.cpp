@@ -287,11 +287,11 @@ void fill_area_in_cahrmatrix(tools::CharMatrix& matrix, const Point64_t2d& start
 			continue;
 		
 		// Prfe ob Position bereits eine Wand ist
-		if (matrix[y][x] == '#')
+		if (matrix.at_unchecked(y, x) == '#')
 			continue;
 		
 		// Flle die Position
-		matrix[y][x] = '#';
+		matrix.at_unchecked(y, x) = '#';
 		
 		// Fge orthogonale Nachbarn zur Queue hinzu
 		std::array<std::pair<int64_t, int64_t>, 4> neighbors = {{
@@ -329,7 +329,7 @@ bool is_rectangle_filled(const tools::CharMatrix& matrix, const Point64_t2d& p1,
 			if (x < 0 || x >= static_cast<int64_t>(matrix.num_cols()))
 				return false;
 			
-			if (matrix[y][x] != '#')
+			if (matrix.at_unchecked(y, x) != '#')
 				return false;
 		}
 	}
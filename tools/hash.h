@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace tools {
+
+    // 64x64 -> 128 bit multiply folded back to 64 bit (wyhash "mum" step)
+    inline uint64_t mum(uint64_t a, uint64_t b) noexcept {
+#if defined(_MSC_VER)
+        unsigned long long high;
+        unsigned long long low = _umul128(a, b, &high);
+        return low ^ high;
+#else
+        unsigned __int128 p = (unsigned __int128)a * b;
+        return (uint64_t)p ^ (uint64_t)(p >> 64);
+#endif
+    }
+
+    // wyhash-style hash of [p, p + n), eight bytes per multiply
+    inline uint64_t hash_bytes(const char* p, size_t n, uint64_t seed) noexcept {
+        constexpr uint64_t k0 = 0xa0761d6478bd642full;
+        constexpr uint64_t k1 = 0xe7037ed1a0b428dbull;
+        constexpr uint64_t k2 = 0x8ebc6af09c88c6e3ull;
+        uint64_t h = seed ^ k0;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, p + i, sizeof(word));
+            h = mum(h ^ word, k1);
+        }
+        if (i < n) {
+            uint64_t tail = 0;
+            std::memcpy(&tail, p + i, n - i);
+            h = mum(h ^ tail, k2);
+        }
+        return mum(h ^ n, k1);
+    }
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace tools {
+
+    // Memory mapping of a whole file. The contents stay valid as long as the
+    // object lives; an empty file yields an empty view. A copy_on_write mapping
+    // may be modified, changes stay private to the process and never reach the file.
+    class MappedFile {
+    public:
+        enum class Access { read_only, copy_on_write };
+
+        explicit MappedFile(const std::filesystem::path& path, Access access = Access::read_only);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        const char* data() const noexcept { return data_; }
+        // only valid for copy_on_write mappings
+        char* mutable_data() noexcept { return const_cast<char*>(data_); }
+        bool is_writable() const noexcept { return access_ == Access::copy_on_write; }
+        size_t size() const noexcept { return size_; }
+        std::string_view view() const noexcept { return { data_, size_ }; }
+
+    private:
+        void release() noexcept;
+
+        const char* data_{};
+        size_t size_{};
+        Access access_{ Access::read_only };
+#if defined(_WIN32)
+        void* file_handle_{};
+        void* mapping_handle_{};
+#endif
+    };
+}
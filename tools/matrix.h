@@ -8,26 +8,237 @@
 #include <span>
 #include <iostream>
 #include <functional>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include "hash.h"
+#include "mapped-file.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TOOLS_MATRIX_SSE2 1
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TOOLS_MATRIX_AVX2 1
+#endif
 
 namespace tools {
+    namespace detail {
+        // edge length of the square tiles used by transpose
+        constexpr size_t transpose_block = 16;
+
+        // transposes one tile of a row-major source into a row-major destination
+        template<class T>
+        inline void transpose_tile(const T* src, size_t src_stride, T* dst, size_t dst_stride, size_t tile_rows, size_t tile_cols) {
+            for (size_t r = 0; r < tile_rows; ++r) {
+                for (size_t c = 0; c < tile_cols; ++c) {
+                    dst[c * dst_stride + r] = src[r * src_stride + c];
+                }
+            }
+        }
+
+#if defined(TOOLS_MATRIX_SSE2)
+        // 16x16 byte tile: four rounds of unpacking row i with row i+8 rotate the
+        // (row, lane) index bits by one position each, so after four rounds row
+        // and lane index are swapped.
+        inline void transpose_tile_16x16_bytes(const void* src, size_t src_stride, void* dst, size_t dst_stride) {
+            const auto* in = static_cast<const char*>(src);
+            auto* out = static_cast<char*>(dst);
+            __m128i x[16];
+            __m128i y[16];
+            for (size_t i = 0; i < 16; ++i) {
+                x[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * src_stride));
+            }
+            for (int round = 0; round < 4; ++round) {
+                for (size_t i = 0; i < 8; ++i) {
+                    y[2 * i] = _mm_unpacklo_epi8(x[i], x[i + 8]);
+                    y[2 * i + 1] = _mm_unpackhi_epi8(x[i], x[i + 8]);
+                }
+                std::copy(std::begin(y), std::end(y), std::begin(x));
+            }
+            for (size_t i = 0; i < 16; ++i) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * dst_stride), x[i]);
+            }
+        }
+#endif
+
+        // number of bytes equal to value in [p, p + n): compare 32 (AVX2) or
+        // 16 (SSE2) bytes at once and popcount the resulting bit mask
+        inline size_t count_bytes(const char* p, size_t n, char value) {
+            size_t count = 0;
+            size_t i = 0;
+#if defined(TOOLS_MATRIX_AVX2)
+            const __m256i needle256 = _mm256_set1_epi8(value);
+            for (; i + 32 <= n; i += 32) {
+                const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                const auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle256)));
+                count += static_cast<size_t>(std::popcount(mask));
+            }
+#endif
+#if defined(TOOLS_MATRIX_SSE2)
+            const __m128i needle128 = _mm_set1_epi8(value);
+            for (; i + 16 <= n; i += 16) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle128)));
+                count += static_cast<size_t>(std::popcount(mask));
+            }
+#endif
+            for (; i < n; ++i) {
+                count += (p[i] == value);
+            }
+            return count;
+        }
+    }
+
+    // Range over every stride-th element starting at first, e.g. a matrix column.
+    // Iterators count the elements still ahead instead of comparing pointers,
+    // so no pointer beyond the last element is ever formed.
+    template<class T>
+    class StridedRange {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::remove_const_t<T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+
+            iterator() = default;
+            iterator(T* p, size_t left, size_t s) : ptr(p), remaining(left), stride(s) {}
+
+            T& operator*() const { return *ptr; }
+            iterator& operator++() {
+                if (--remaining > 0) ptr += stride;
+                return *this;
+            }
+            iterator operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+            bool operator==(const iterator& other) const { return remaining == other.remaining; }
+
+        private:
+            T* ptr{};
+            size_t remaining{};
+            size_t stride{};
+        };
+
+        StridedRange(T* first, size_t count, size_t stride) : first(first), count(count), stride(stride) {}
+
+        size_t size() const { return count; }
+        T& operator[](size_t i) const { return first[i * stride]; }
+        iterator begin() const { return iterator(first, count, stride); }
+        iterator end() const { return iterator(first, 0, stride); }
+
+    private:
+        T* first;
+        size_t count;
+        size_t stride;
+    };
+
+    template<class T>
+    class Matrix;
+
+    // Read-only transposed view of a matrix; no data is copied. The view must
+    // not outlive the matrix it refers to.
+    template<class T>
+    class TransposedView {
+    public:
+        explicit TransposedView(const Matrix<T>& m) : matrix(&m) {}
+
+        size_t num_rows() const { return matrix->num_cols(); }
+        size_t num_cols() const { return matrix->num_rows(); }
+
+        const T& operator()(size_t r, size_t c) const {
+            return matrix->at_unchecked(c, r);
+        }
+
+        // row r of the view is column r of the matrix
+        StridedRange<const T> get_row(size_t r) const {
+            return matrix->column(r);
+        }
+
+        // copy the view into a real matrix
+        Matrix<T> materialize() const {
+            Matrix<T> result = *matrix;
+            result.transpose();
+            return result;
+        }
+
+    private:
+        const Matrix<T>* matrix;
+    };
+
     template<class T>
     class Matrix {
     public:
         Matrix() = default;
         // basic constructor: allocate storage
-        Matrix(size_t r, size_t c) : data(r* c), rows(r), cols(c) {}
-        Matrix(size_t r, size_t c,T v) : data(r*c,v), rows(r), cols(c) {}
+        Matrix(size_t r, size_t c) : storage(r* c), rows(r), cols(c) { adopt_storage(); }
+        Matrix(size_t r, size_t c,T v) : storage(r*c,v), rows(r), cols(c) { adopt_storage(); }
 
         // construct from span of elements (copied)
-        Matrix(size_t r, size_t c, std::span<const T> data_) : data(data_.begin(), data_.end()), rows(r), cols(c) {
-            if (data.size() != r * c)
+        Matrix(size_t r, size_t c, std::span<const T> data_) : storage(data_.begin(), data_.end()), rows(r), cols(c) {
+            if (storage.size() != r * c)
                 throw std::runtime_error("Data size does not match matrix dimensions");
+            adopt_storage();
         }
 
         // construct taking ownership of a vector
-        Matrix(size_t r, size_t c, std::vector<T> data_) : data(std::move(data_)), rows(r), cols(c) {
-            if (data.size() != r * c)
+        Matrix(size_t r, size_t c, std::vector<T> data_) : storage(std::move(data_)), rows(r), cols(c) {
+            if (storage.size() != r * c)
                 throw std::runtime_error("Data size does not match matrix dimensions");
+            adopt_storage();
+        }
+
+        // construct on top of a copy-on-write file mapping: row r starts at
+        // byte r * stride of the mapping, no data is copied
+        Matrix(std::shared_ptr<MappedFile> file, size_t r, size_t c, size_t stride)
+            requires std::is_same_v<T, char>
+            : mapping(std::move(file)), rows(r), cols(c), row_stride(stride) {
+            if (!mapping->is_writable())
+                throw std::runtime_error("Matrix requires a copy-on-write mapping");
+            if (r > 0 && (stride < c || (r - 1) * stride + c > mapping->size()))
+                throw std::runtime_error("Mapped file does not match matrix dimensions");
+            first = mapping->mutable_data();
+        }
+
+        // copies are always independent, contiguous matrices
+        Matrix(const Matrix& other) : rows(other.rows), cols(other.cols) {
+            if (other.is_contiguous()) {
+                storage.assign(other.first, other.first + rows * cols);
+            }
+            else {
+                storage.reserve(rows * cols);
+                for (size_t r = 0; r < rows; ++r) {
+                    auto row = other.get_row(r);
+                    storage.insert(storage.end(), row.begin(), row.end());
+                }
+            }
+            adopt_storage();
+        }
+
+        Matrix(Matrix&& other) noexcept
+            : storage(std::move(other.storage)), mapping(std::move(other.mapping)), first(other.first),
+              rows(other.rows), cols(other.cols), row_stride(other.row_stride) {
+            other.clear();
+        }
+
+        Matrix& operator=(Matrix other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        void swap(Matrix& other) noexcept {
+            std::swap(storage, other.storage);
+            std::swap(mapping, other.mapping);
+            std::swap(first, other.first);
+            std::swap(rows, other.rows);
+            std::swap(cols, other.cols);
+            std::swap(row_stride, other.row_stride);
         }
 
         size_t num_rows() const {
@@ -37,16 +248,78 @@ namespace tools {
             return cols;
         }
 
+        // raw element access: row r starts at data() + r * stride()
+        T* data() {
+            return first;
+        }
+        const T* data() const {
+            return first;
+        }
+        size_t stride() const {
+            return row_stride;
+        }
+
+        // bounds-checked element access
+        T& at(size_t r, size_t c) {
+            check_index(r, c);
+            return first[r * row_stride + c];
+        }
+        const T& at(size_t r, size_t c) const {
+            check_index(r, c);
+            return first[r * row_stride + c];
+        }
+
+        // element access without any bounds check, for hot loops
+        T& at_unchecked(size_t r, size_t c) {
+            return first[r * row_stride + c];
+        }
+        const T& at_unchecked(size_t r, size_t c) const {
+            return first[r * row_stride + c];
+        }
+
         // return a span referencing the row (mutable)
         std::span<T> get_row(size_t r) {
             if (r >= rows) throw std::out_of_range("row index out of range");
-            return std::span<T>(data.data() + r * cols, cols);
+            return std::span<T>(first + r * row_stride, cols);
         }
 
         // return a span referencing the row (const)
         std::span<const T> get_row(size_t r) const {
             if (r >= rows) throw std::out_of_range("row index out of range");
-            return std::span<const T>(data.data() + r * cols, cols);
+            return std::span<const T>(first + r * row_stride, cols);
+        }
+
+        // strided view of column c
+        StridedRange<T> column(size_t c) {
+            if (c >= cols) throw std::out_of_range("column index out of range");
+            return StridedRange<T>(first + c, rows, row_stride);
+        }
+        StridedRange<const T> column(size_t c) const {
+            if (c >= cols) throw std::out_of_range("column index out of range");
+            return StridedRange<const T>(first + c, rows, row_stride);
+        }
+
+        // calls f(value) for each of the up to eight neighbours of (r, c); the
+        // window is clipped to the matrix once, so the loop itself is unchecked
+        template<class F>
+        void for_each_neighbour(size_t r, size_t c, F&& f) const {
+            const size_t r_begin = r > 0 ? r - 1 : 0;
+            const size_t r_end = std::min(rows, r + 2);
+            const size_t c_begin = c > 0 ? c - 1 : 0;
+            const size_t c_end = std::min(cols, c + 2);
+            for (size_t nr = r_begin; nr < r_end; ++nr) {
+                const T* row = first + nr * row_stride;
+                for (size_t nc = c_begin; nc < c_end; ++nc) {
+                    if (nr != r || nc != c) f(row[nc]);
+                }
+            }
+        }
+
+        // number of neighbours of (r, c) equal to value
+        size_t count_neighbours(size_t r, size_t c, const T& value) const {
+            size_t count = 0;
+            for_each_neighbour(r, c, [&](const T& v) { count += (v == value); });
+            return count;
         }
 
         // allow M[r][c] access using spans
@@ -57,43 +330,119 @@ namespace tools {
             return get_row(r);
         }
 
+        // cache-blocked transpose; square matrices are transposed in place
         void transpose() {
-            std::vector<T> transposed(data.size());
-            for (size_t r = 0; r < rows; ++r) {
-                for (size_t c = 0; c < cols; ++c) {
-                    transposed[c * rows + r] = data[r * cols + c];
+            constexpr size_t B = detail::transpose_block;
+            if (rows == cols) {
+                transpose_square_in_place();
+                return;
+            }
+            std::vector<T> transposed(rows * cols);
+            for (size_t rb = 0; rb < rows; rb += B) {
+                const size_t tile_rows = std::min(B, rows - rb);
+                for (size_t cb = 0; cb < cols; cb += B) {
+                    const size_t tile_cols = std::min(B, cols - cb);
+                    const T* src = first + rb * row_stride + cb;
+                    T* dst = transposed.data() + cb * rows + rb;
+#if defined(TOOLS_MATRIX_SSE2)
+                    if constexpr (sizeof(T) == 1 && std::is_trivially_copyable_v<T>) {
+                        if (tile_rows == B && tile_cols == B) {
+                            detail::transpose_tile_16x16_bytes(src, row_stride, dst, rows);
+                            continue;
+                        }
+                    }
+#endif
+                    detail::transpose_tile(src, row_stride, dst, rows, tile_rows, tile_cols);
                 }
-			}
-            data = std::move(transposed);
+            }
             std::swap(rows, cols);
-		}
+            storage = std::move(transposed);
+            mapping.reset();
+            adopt_storage();
+        }
+
+        // lazy alternative to transpose() for read-only access
+        TransposedView<T> transposed_view() const {
+            return TransposedView<T>(*this);
+        }
 
         std::vector<T> pop_last_row() {
             if (rows == 0) {
                 throw std::runtime_error("No rows to pop");
             }
-            std::vector<T> last_row(data.end() - cols, data.end());
-            data.resize(data.size() - cols);
+            auto row = get_row(rows - 1);
+            std::vector<T> last_row(row.begin(), row.end());
+            if (!mapping) {
+                storage.resize(storage.size() - cols);
+            }
             --rows;
             return last_row;
 		}
 
+        // number of '#' cells, counted row by row with the SIMD byte counter
         size_t count_elements() const
 			requires std::is_same_v<T, char>
         {
-            std::optional<size_t> count; 
-            if(!count)
-            {
-                char value = '#';
-                count = std::count(data.begin(), data.end(), value);
+            size_t count = 0;
+            for (size_t r = 0; r < rows; ++r) {
+                count += detail::count_bytes(first + r * row_stride, cols, fill_char);
             }
-			return *count;
+			return count;
 		}
 
     private:
-        std::vector<T> data{ 0 };
+        // value counted by count_elements()
+        static constexpr char fill_char = '#';
+
+        void check_index(size_t r, size_t c) const {
+            if (r >= rows) throw std::out_of_range("row index out of range");
+            if (c >= cols) throw std::out_of_range("column index out of range");
+        }
+
+        bool is_contiguous() const {
+            return row_stride == cols || rows <= 1;
+        }
+
+        // point the element view at the owned storage
+        void adopt_storage() {
+            first = storage.data();
+            row_stride = cols;
+        }
+
+        void clear() noexcept {
+            storage.clear();
+            mapping.reset();
+            first = nullptr;
+            rows = cols = row_stride = 0;
+        }
+
+        // swaps the tiles above the diagonal with their mirror images
+        void transpose_square_in_place() {
+            constexpr size_t B = detail::transpose_block;
+            const size_t n = rows;
+            const size_t s = row_stride;
+            for (size_t rb = 0; rb < n; rb += B) {
+                const size_t r_end = std::min(n, rb + B);
+                for (size_t cb = rb; cb < n; cb += B) {
+                    const size_t c_end = std::min(n, cb + B);
+                    for (size_t r = rb; r < r_end; ++r) {
+                        for (size_t c = std::max(cb, r + 1); c < c_end; ++c) {
+                            std::swap(first[r * s + c], first[c * s + r]);
+                        }
+                    }
+                }
+            }
+        }
+
+        // owned elements; empty while the matrix lives on a file mapping
+        std::vector<T> storage{};
+        // keeps mapped elements alive
+        std::shared_ptr<MappedFile> mapping{};
+        // element (0, 0); row r starts at first + r * row_stride
+        T* first{};
         size_t rows{};
         size_t cols{};
+        size_t row_stride{};
 
     };
 
@@ -120,47 +469,61 @@ namespace tools {
     {
         if (lhs.num_rows() != rhs.num_rows() || lhs.num_cols() != rhs.num_cols())
             return false;
+        const size_t cols = lhs.num_cols();
+        if (lhs.stride() == cols && rhs.stride() == cols)
+            return lhs.num_rows() * cols == 0 || std::memcmp(lhs.data(), rhs.data(), lhs.num_rows() * cols) == 0;
         for (size_t r = 0; r < lhs.num_rows(); ++r) {
-            auto row_lhs = lhs.get_row(r);
-            auto row_rhs = rhs.get_row(r);
-            for (size_t c = 0; c < lhs.num_cols(); ++c) {
-                if (row_lhs[c] != row_rhs[c])
-                    return false;
-            }
+            if (std::memcmp(lhs.data() + r * lhs.stride(), rhs.data() + r * rhs.stride(), cols) != 0)
+                return false;
         }
         return true;
     }
 
+    // Loads a text grid. If all lines have the same length and end in a plain
+    // '\n', the matrix is built directly on a copy-on-write mapping of the
+    // file (the '\n' becomes part of the row stride). Ragged or CRLF input is
+    // padded with ' ' and copied once into owned storage.
     inline CharMatrix read_matrix_from_file(const std::string& filename) {
-        std::ifstream is(filename);
-        if (!is.is_open()) {
-            throw std::runtime_error("Unable to open file: " + filename);
+        auto file = std::make_shared<MappedFile>(filename, MappedFile::Access::copy_on_write);
+        std::string_view text = file->view();
+
+        // fast path: detect the stride from the first line, then verify every line
+        const size_t cols = std::min(text.find('\n'), text.size());
+        const bool crlf = cols > 0 && text[cols - 1] == '\r';
+        if (!crlf && cols > 0) {
+            const size_t stride = cols + 1;
+            const size_t rows = (text.size() + 1) / stride;
+            bool uniform = rows * stride == text.size() || rows * stride == text.size() + 1;
+            for (size_t r = 0; uniform && r < rows; ++r) {
+                const std::string_view line = text.substr(r * stride, cols);
+                const size_t eol = r * stride + cols;
+                uniform = line.find('\n') == std::string_view::npos
+                    && line.back() != '\r'
+                    && (eol == text.size() || text[eol] == '\n');
+            }
+            if (uniform) {
+                return CharMatrix(std::move(file), rows, cols, stride);
+            }
         }
 
-        std::vector<std::string> lines;
-        std::string line;
-        while (std::getline(is, line)) {
+        // fallback: collect line views, then copy once into a padded buffer
+        std::vector<std::string_view> lines;
+        size_t max_cols = 0;
+        while (!text.empty()) {
+            const size_t eol = text.find('\n');
+            std::string_view line = text.substr(0, eol);
+            text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
             // remove possible CR from CRLF
-            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            max_cols = std::max(max_cols, line.size());
             lines.push_back(line);
         }
 
-        size_t rows = lines.size();
-        size_t cols = 0;
-        for (const auto& l : lines) cols = std::max(cols, l.size());
-
-        // flatten into a single vector and use the vector-taking constructor
-        std::vector<char> flat;
-        flat.reserve(rows * cols);
-        for (size_t r = 0; r < rows; ++r) {
-            const auto& l = lines[r];
-            for (size_t c = 0; c < cols; ++c) {
-                char ch = (c < l.size()) ? l[c] : ' ';
-                flat.push_back(ch);
-            }
+        std::vector<char> flat(lines.size() * max_cols, ' ');
+        for (size_t r = 0; r < lines.size(); ++r) {
+            std::copy(lines[r].begin(), lines[r].end(), flat.begin() + r * max_cols);
         }
-
-        return CharMatrix(rows, cols, std::move(flat));
+        return CharMatrix(lines.size(), max_cols, std::move(flat));
     }
 
     inline void print_charmatrix(const CharMatrix& matrix) {
@@ -261,18 +624,15 @@ namespace std {
     template<>
     struct hash<tools::CharMatrix>
     {
+        // rows are hashed one after another, so mapped and owned matrices with
+        // the same contents hash equal regardless of their row stride
         size_t operator()(const tools::CharMatrix& matrix) const noexcept
         {
-            constexpr size_t mix = 0x9e3779b97f4a7c15ull;
-            size_t seed = matrix.num_rows();
-            seed ^= matrix.num_cols() + mix + (seed << 6) + (seed >> 2);
+            uint64_t seed = tools::mum(matrix.num_rows() ^ 0x9e3779b97f4a7c15ull, matrix.num_cols() ^ 0x3c6ef372fe94f82aull);
             for (size_t r = 0; r < matrix.num_rows(); ++r) {
-                auto row = matrix.get_row(r);
-                for (size_t c = 0; c < matrix.num_cols(); ++c) {
-                    seed ^= static_cast<unsigned char>(row[c]) + mix + (seed << 6) + (seed >> 2);
-                }
+                seed = tools::hash_bytes(matrix.data() + r * matrix.stride(), matrix.num_cols(), seed);
             }
-            return seed;
+            return static_cast<size_t>(seed);
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace tools {
+
+    // number of worker threads to use (at least one)
+    inline size_t worker_count() {
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // rethrows the first exception a worker stored, after all workers joined
+    inline void rethrow_first(const std::vector<std::exception_ptr>& errors) {
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Splits [0, count) into contiguous chunks, one per worker. Each worker
+    // transforms and reduces its chunk locally starting from `identity`, the
+    // partial results are then reduced in chunk order on the calling thread.
+    // An exception thrown by a worker is rethrown here.
+    template<class T, class Reduce, class Transform>
+    T parallel_transform_reduce(size_t count, T identity, Reduce reduce, Transform transform) {
+        const size_t workers = std::min(worker_count(), std::max<size_t>(1, count));
+        const size_t chunk = (count + workers - 1) / workers;
+        std::vector<T> partial(workers, identity);
+        std::vector<std::exception_ptr> errors(workers);
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(workers);
+            for (size_t w = 0; w < workers; ++w) {
+                threads.emplace_back([&, w] {
+                    try {
+                        const size_t first = w * chunk;
+                        const size_t last = std::min(count, first + chunk);
+                        T local = identity;
+                        for (size_t i = first; i < last; ++i) {
+                            local = reduce(std::move(local), transform(i));
+                        }
+                        partial[w] = std::move(local);
+                    }
+                    catch (...) {
+                        errors[w] = std::current_exception();
+                    }
+                });
+            }
+        }
+        rethrow_first(errors);
+        T result = std::move(partial[0]);
+        for (size_t w = 1; w < workers; ++w) {
+            result = reduce(std::move(result), partial[w]);
+        }
+        return result;
+    }
+
+    // Runs f(worker, i) for every i in [0, count) on `workers` threads. Indices
+    // are handed out one at a time from a shared counter, so a worker that
+    // finishes a cheap item immediately pulls the next one and uneven item
+    // costs balance out. `worker` lets callers keep per-thread state. If f
+    // throws, that worker stops, the others finish their items, and the first
+    // exception is rethrown here.
+    template<class F>
+    void parallel_for_dynamic(size_t workers, size_t count, F f) {
+        std::atomic<size_t> next{ 0 };
+        std::vector<std::exception_ptr> errors(workers);
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(workers);
+            for (size_t w = 0; w < workers; ++w) {
+                threads.emplace_back([&, w] {
+                    try {
+                        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+                             i = next.fetch_add(1, std::memory_order_relaxed)) {
+                            f(w, i);
+                        }
+                    }
+                    catch (...) {
+                        errors[w] = std::current_exception();
+                    }
+                });
+            }
+        }
+        rethrow_first(errors);
+    }
+}